@@ -1,18 +1,42 @@
+#include <QFileSystemWatcher>
+#include <QSocketNotifier>
 #include <QThread>
 #include <QTimer>
 #include <QFile>
 
+#include <functional>
+#include <limits>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Types/PhaseProfile.hpp"
+
 #include "BladeRfDeviceController.hpp"
+#include "ControlServer.hpp"
+#include "MissionScheduler.hpp"
 #include "RawDataWriter.hpp"
 #include "Application.hpp"
 
+#define SETTINGS_FILE           "settings.json"
+#define SETTINGS_SETTLE_MS      300     // editors write a file in several steps
+
 #define DeviceCall(device, command)                     QMetaObject::invokeMethod(device, &BladeRfDeviceController::command, Qt::QueuedConnection);
 #define DeviceCallArgs(device, command, argsType, args) QMetaObject::invokeMethod(device, command, Qt::QueuedConnection, Q_ARG(argsType, args));
 
+static int eventTriggerPipe[2] = { -1, -1 };
+
 Application::Application(int argc, char** argv)
     : QCoreApplication(argc, argv)
 {
     QTimer::singleShot(0, this, &Application::onEventLoopStarted);
+
+    if (pipe2(eventTriggerPipe, O_NONBLOCK | O_CLOEXEC) == 0)
+    {
+        mEventTriggerNotifier = new QSocketNotifier(eventTriggerPipe[0], QSocketNotifier::Read, this);
+        connect(mEventTriggerNotifier, &QSocketNotifier::activated,
+                this,                  &Application::onEventTriggerRequested);
+    }
 }
 
 Application::~Application()
@@ -26,7 +50,11 @@ Application::~Application()
     };
 
     deleteThreaded(mDevice);
-    deleteThreaded(mWriter);
+    if (mWriterThread)
+    {
+        mWriterThread->quit();
+        mWriterThread->wait();
+    }
 }
 
 void Application::exit(int code)
@@ -35,24 +63,49 @@ void Application::exit(int code)
     QCoreApplication::exit(code);
 }
 
+void Application::requestEventTrigger()
+{
+    const char request = 0;
+    if (eventTriggerPipe[1] < 0) return;
+    if (::write(eventTriggerPipe[1], &request, sizeof(request)) < 0)
+        return; // pipe is full, a trigger is already pending
+}
+
 void Application::onEventLoopStarted()
 {
     bladerf_devinfo* deviceList = nullptr;
-    QFile settingsFile("settings.json");
+    QFile settingsFile(SETTINGS_FILE);
 
     if (!settingsFile.open(QIODevice::ReadOnly))
         qFatal("Can't open settings file: %s", qPrintable(settingsFile.errorString()));
 
     const auto fileContent = settingsFile.readAll();
-    mConfig.raw(fileContent);
+    mScheduler = new MissionScheduler(QJsonDocument::fromJson(fileContent).object(), this);
 
-    if (!mConfig.valid())
+    if (!mScheduler->valid())
         qFatal("Settings file invalid!");
 
+    mSettingsTimer = new QTimer(this);
+    mSettingsTimer->setSingleShot(true);
+    mSettingsTimer->setInterval(SETTINGS_SETTLE_MS);
+    mSettingsWatcher = new QFileSystemWatcher(this);
+    mSettingsWatcher->addPath(SETTINGS_FILE);
+
+    connect(mSettingsWatcher, &QFileSystemWatcher::fileChanged,
+            this,             [this]() { mSettingsTimer->start(); });
+    connect(mSettingsTimer,   &QTimer::timeout,
+            this,             &Application::onSettingsChanged);
+
+    PhaseProfile profile;
+    profile.start();
+
     const auto count = bladerf_get_device_list(&deviceList);
     if (count < 0) qFatal("No bladeRF devices found!");
     else qInfo("%i bladeRF devices found. Using first...", count);
 
+    profile.mark("device list");
+    qInfo("Startup: %s", qPrintable(profile.summary()));
+
     const auto deviceInfo = deviceList[0];
     auto device = new BladeRfDeviceController;
     auto thread = new QThread(this);
@@ -75,24 +128,16 @@ void Application::onEventLoopStarted()
             this,   &Application::onSessionStopped,
             Qt::QueuedConnection);
 
-    if (mConfig.direction == Direction::RX)
-    {
-        const auto thread = new QThread(this);
-        mWriter = new RawDataWriter;
+    connect(mScheduler, &MissionScheduler::sessionRequested,
+            this,       &Application::onSessionRequested);
+    connect(mScheduler, &MissionScheduler::stopRequested,
+            this,       [this]() { DeviceCall(mDevice, sessionStop); });
+    connect(mScheduler, &MissionScheduler::finished,
+            this,       [this]() { exit(0); });
 
-        connect(thread,  &QThread::started,
-                mWriter, &RawDataWriter::init);
-        connect(thread,  &QThread::finished,
-                mWriter, &RawDataWriter::deleteLater);
-
-        connect(device,  &BladeRfDeviceController::rxDataAvailable,
-                mWriter, &RawDataWriter::onData,
-                Qt::QueuedConnection);
-
-        mWriter->moveToThread(thread);
-        thread->setObjectName("rx writer");
-        thread->start();
-    }
+    mWriterThread = new QThread(this);
+    mWriterThread->setObjectName("rx writer");
+    mWriterThread->start();
 
     device->moveToThread(thread);
     thread->setObjectName(deviceInfo.serial);
@@ -105,10 +150,201 @@ void Application::onEventLoopStarted()
     bladerf_free_device_list(deviceList);
 }
 
+void Application::onSessionRequested(const MissionConfig& config)
+{
+    mConfig = config;
+
+    if (mConfig.direction != Direction::TX)
+    {
+        mWriter = new RawDataWriter(mConfig);
+
+        connect(mWriterThread, &QThread::finished,
+                mWriter,       &RawDataWriter::deleteLater);
+
+        connect(mDevice, &BladeRfDeviceController::rxDataAvailable,
+                mWriter, &RawDataWriter::enqueue,
+                Qt::DirectConnection);
+        connect(mDevice, &BladeRfDeviceController::eventTriggered,
+                mWriter, &RawDataWriter::onTrigger,
+                Qt::QueuedConnection);
+
+        mWriter->moveToThread(mWriterThread);
+        QMetaObject::invokeMethod(mWriter, &RawDataWriter::init, Qt::QueuedConnection);
+    }
+
+    const auto device = mDevice;
+    QMetaObject::invokeMethod(device, [device, config]() { device->sessionStart(config); }, Qt::QueuedConnection);
+}
+
+void Application::writerStop()
+{
+    if (!mWriter) return;
+
+    // The stream is stopped, nothing is enqueued anymore; the writer drains and
+    // saves its metadata on its own thread
+    disconnect(mDevice, nullptr, mWriter, nullptr);
+    mWriter->deleteLater();
+    mWriter = nullptr;
+}
+
+void Application::onSettingsChanged()
+{
+    // Saving by rename drops the file from the watcher
+    if (!mSettingsWatcher->files().contains(SETTINGS_FILE))
+        mSettingsWatcher->addPath(SETTINGS_FILE);
+
+    QFile settingsFile(SETTINGS_FILE);
+    if (!settingsFile.open(QIODevice::ReadOnly))
+    {
+        qWarning("Can't reload settings file: %s", qPrintable(settingsFile.errorString()));
+        return;
+    }
+
+    const auto settings = QJsonDocument::fromJson(settingsFile.readAll()).object();
+    const auto previous = mScheduler->currentSettings();
+
+    if (settings.isEmpty() || !mScheduler->reload(settings))
+    {
+        qWarning("Settings file changed but is invalid, keeping the current settings");
+        return;
+    }
+
+    const auto current = mScheduler->currentSettings();
+    QStringList keys = previous.keys() + current.keys();
+    keys.removeDuplicates();
+
+    // Applied on the running stream
+    static const QStringList liveKeys { "frequency", "gain", "tx_gain_db" };
+    // Taken by the scheduler for the next runs
+    static const QStringList scheduleKeys { "tryes", "duration", "output_directory", "missions", "start_times", "control_socket" };
+
+    QStringList changed;
+    bool restart = false;
+
+    for (const auto& key : keys)
+    {
+        if (previous[key] == current[key]) continue;
+
+        changed << key;
+        if (!liveKeys.contains(key) && !scheduleKeys.contains(key)) restart = true;
+    }
+
+    if (changed.isEmpty()) return;
+    qInfo("Settings reloaded, changed: %s", qPrintable(changed.join(", ")));
+
+    if (!mSessionRunning) return;
+    if (restart)
+    {
+        qInfo("Restarting the session for the new settings");
+        mScheduler->restart();
+        return;
+    }
+
+    MissionConfig config;
+    config.fromJson(current);
+
+    const auto device = mDevice;
+
+    // A scan sets the frequency itself
+    if (changed.contains("frequency") && !config.scan.enabled())
+        QMetaObject::invokeMethod(device, [device, config]() { device->retune(config.frequency); }, Qt::QueuedConnection);
+    if (changed.contains("gain"))
+        QMetaObject::invokeMethod(device, [device, config]() { device->setGain(config.gain); }, Qt::QueuedConnection);
+    if (changed.contains("tx_gain_db"))
+        QMetaObject::invokeMethod(device, [device, config]() { device->setTxGain(config.txGainDb); }, Qt::QueuedConnection);
+
+    mConfig.frequency = config.frequency;
+    mConfig.gain = config.gain;
+    mConfig.txGainDb = config.txGainDb;
+}
+
+void Application::onEventTriggerRequested()
+{
+    char requests[64];
+    while (::read(eventTriggerPipe[0], requests, sizeof(requests)) > 0);
+
+    qInfo("Event trigger requested");
+    if (mWriter) QMetaObject::invokeMethod(mWriter, &RawDataWriter::onTrigger, Qt::QueuedConnection);
+}
+
 void Application::onDeviceOpened()
 {
     mDevice->printAboutDevice();
-    mDevice->sessionStart(mConfig);
+
+    if (!mScheduler->first().controlSocket.isEmpty())
+    {
+        mControl = new ControlServer(this);
+        connect(mControl, &ControlServer::commandReceived,
+                this,     &Application::onControlCommand);
+        mControl->listen(mScheduler->first().controlSocket);
+    }
+
+    mScheduler->start();
+}
+
+void Application::onControlCommand(quint64 client, const QStringList& command)
+{
+    const auto device = mDevice;
+    const auto control = mControl;
+    const auto name = command.first();
+
+    // Device calls run on the controller thread, the reply is sent back from here
+    const auto deviceCall = [this, device, control, client](std::function<bool()> call,
+                                                            const QByteArray& failure = "device call failed") {
+        QMetaObject::invokeMethod(device, [this, control, client, call, failure]() {
+            const bool ok = call();
+            QMetaObject::invokeMethod(this, [control, client, ok, failure]() {
+                control->reply(client, ok, ok ? QByteArray() : failure);
+            }, Qt::QueuedConnection);
+        }, Qt::QueuedConnection);
+    };
+
+    if (name == "retune" && command.size() == 2)
+    {
+        bool ok = false;
+        const auto frequency = command[1].toULongLong(&ok);
+        if (!ok || frequency == 0) control->reply(client, false, "bad frequency");
+        else deviceCall([device, frequency]() { return device->retune(frequency); });
+    }
+    else if (name == "gain" && command.size() == 2)
+    {
+        bool ok = false;
+        const auto gain = command[1].toInt(&ok);
+
+        // The session keeps the gain unsigned, the device checks its own range
+        if (!ok || gain < 0 || gain > std::numeric_limits<unsigned short>::max())
+            control->reply(client, false, "bad gain");
+        else deviceCall([device, gain]() { return device->setGain(gain); }, "bad gain");
+    }
+    else if (name == "stop")
+    {
+        mScheduler->hold();
+        control->reply(client, true);
+    }
+    else if (name == "start")
+    {
+        const bool ok = mScheduler->resume();
+        control->reply(client, ok, ok ? QByteArray() : "session is running");
+    }
+    else if (name == "rotate")
+    {
+        if (!mWriter) control->reply(client, false, "no capture running");
+        else
+        {
+            QMetaObject::invokeMethod(mWriter, &RawDataWriter::rotate, Qt::QueuedConnection);
+            control->reply(client, true);
+        }
+    }
+    else if (name == "stats")
+    {
+        QMetaObject::invokeMethod(device, [this, device, control, client]() {
+            const auto status = QJsonDocument(device->status()).toJson(QJsonDocument::Compact);
+            QMetaObject::invokeMethod(this, [control, client, status]() {
+                control->reply(client, true, status);
+            }, Qt::QueuedConnection);
+        }, Qt::QueuedConnection);
+    }
+    else control->reply(client, false, "unknown command");
 }
 
 void Application::onDeviceClosed()
@@ -125,9 +361,14 @@ void Application::onDeviceError()
 void Application::onSessionStarted()
 {
     qDebug("Session started");
+    mSessionRunning = true;
+    mScheduler->onSessionStarted();
 }
 
 void Application::onSessionStopped()
 {
     qDebug("Session stopped");
+    mSessionRunning = false;
+    writerStop();
+    mScheduler->onSessionStopped();
 }
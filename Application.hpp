@@ -5,7 +5,13 @@
 
 #include "Types/MissionConfig.hpp"
 
+class QFileSystemWatcher;
+class QSocketNotifier;
+class QTimer;
+class QThread;
 class BladeRfDeviceController;
+class ControlServer;
+class MissionScheduler;
 class RawDataWriter;
 class RawData;
 
@@ -18,8 +24,12 @@ public:
 
     void exit(int code = 0);
 
+    /// Async-signal-safe request of an event trigger (SIGUSR1)
+    static void requestEventTrigger();
+
 private slots:
     void onEventLoopStarted();
+    void onEventTriggerRequested();
 
 private slots:
     void onDeviceOpened();
@@ -27,11 +37,24 @@ private slots:
     void onDeviceError();
     void onSessionStarted();
     void onSessionStopped();
+    void onSessionRequested(const MissionConfig& config);
+    void onControlCommand(quint64 client, const QStringList& command);
+    void onSettingsChanged();
+
+private:
+    void writerStop();
 
 private:
     BladeRfDeviceController* mDevice = nullptr;
     RawDataWriter* mWriter = nullptr;
+    QThread* mWriterThread = nullptr;
+    MissionScheduler* mScheduler = nullptr;
+    ControlServer* mControl = nullptr;
+    QSocketNotifier* mEventTriggerNotifier = nullptr;
+    QFileSystemWatcher* mSettingsWatcher = nullptr;
+    QTimer* mSettingsTimer = nullptr;
     MissionConfig mConfig;
+    bool mSessionRunning = false;
 
 };
 
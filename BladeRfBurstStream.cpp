@@ -0,0 +1,257 @@
+#include <QFile>
+#include <QDir>
+
+#include <cstring>
+
+#include "Types/RawData.hpp"
+
+#include "BladeRfBurstStream.hpp"
+
+#define ExecStatus(function)    { int status = function; if (status not_eq 0) { return status; } }
+
+#define SYNC_TIMEOUT_MS         1000
+#define SUBMIT_LEAD_SECONDS     0.05    // bursts are handed to libbladeRF this early
+#define MAX_SLEEP_MS            10
+
+BladeRfBurstStream::BladeRfBurstStream(bladerf* deviceHandle, ushort buffersCount)
+    : mDeviceHandle(deviceHandle),
+      mBuffersCount(buffersCount),
+      mProcess(false),
+      mBurstsSent(0),
+      mBurstsLate(0),
+      mSamplesSent(0)
+{
+
+}
+
+BladeRfBurstStream::~BladeRfBurstStream()
+{
+    stop();
+
+    for (auto file : mFiles) file->close();
+    qDeleteAll(mFiles);
+}
+
+void BladeRfBurstStream::addBurst(const Burst& burst)
+{
+    mBursts.append(burst);
+}
+
+int BladeRfBurstStream::addBursts(const MissionConfig& config)
+{
+    for (const auto& burstConfig : config.bursts)
+    {
+        auto file = new QFile(QDir::current().absoluteFilePath(burstConfig.fileName));
+        mFiles.append(file);
+
+        const auto count = quint32(file->size() / SAMPLE_SIZE_BYTES);
+        const auto samples = file->open(QIODevice::ReadOnly) && count
+                           ? reinterpret_cast<const qint16*>(file->map(0, qint64(count) * SAMPLE_SIZE_BYTES))
+                           : nullptr;
+
+        if (!samples)
+        {
+            qWarning("Can't map burst file %s: %s", qPrintable(file->fileName()), qPrintable(file->errorString()));
+            return BLADERF_ERR_IO;
+        }
+
+        for (unsigned i = 0; i < burstConfig.repeat; ++i)
+        {
+            // Repeats are relative to the previous burst, the first one keeps the configured time base
+            if (i == 0) addBurst({ samples, count, burstConfig.timestamp, burstConfig.relative });
+            else        addBurst({ samples, count, burstConfig.period, true });
+        }
+    }
+
+    return 0;
+}
+
+int BladeRfBurstStream::start(const MissionConfig& config, bladerf_channel channel)
+{
+    stop();
+    mConfig = config;
+
+    // The sync interface has to be configured before the module is enabled,
+    // session setup has enabled it already
+    ExecStatus(bladerf_enable_module(mDeviceHandle, channel, false));
+    ExecStatus(bladerf_sync_config(mDeviceHandle,
+                                   BLADERF_TX_X1,
+                                   BLADERF_FORMAT_SC16_Q11_META,
+                                   mBuffersCount,
+                                   config.samplesCount,
+                                   (mBuffersCount > 1) ? mBuffersCount / 2 : 1,
+                                   SYNC_TIMEOUT_MS));
+    ExecStatus(bladerf_enable_module(mDeviceHandle, channel, true));
+
+    mProcess.store(true);
+    mThread = new std::thread(&BladeRfBurstStream::process, this);
+
+    return 0;
+}
+
+int BladeRfBurstStream::stop()
+{
+    if (mThread)
+    {
+        mProcess.store(false);
+        if (mThread->joinable())
+            mThread->join();
+        delete mThread;
+        mThread = nullptr;
+    }
+
+    return 0;
+}
+
+quint64 BladeRfBurstStream::burstsSent() const
+{
+    return mBurstsSent.load();
+}
+
+quint64 BladeRfBurstStream::burstsLate() const
+{
+    return mBurstsLate.load();
+}
+
+SessionStatistics BladeRfBurstStream::statistics() const
+{
+    SessionStatistics statistics;
+
+    statistics.sampleRate = mConfig.sampleRate;
+    statistics.samplesSent = mSamplesSent.load();
+    statistics.burstsSent = mBurstsSent.load();
+    statistics.burstsLate = mBurstsLate.load();
+
+    return statistics;
+}
+
+void BladeRfBurstStream::process()
+{
+    const auto lead = bladerf_timestamp(mConfig.sampleRate * SUBMIT_LEAD_SECONDS);
+    bladerf_timestamp previous = 0;
+    bladerf_timestamp end = 0;
+
+    if (int status = bladerf_get_timestamp(mDeviceHandle, BLADERF_TX, &previous); status != 0)
+    {
+        qWarning("burst stream: failed to get timestamp: %s", bladerf_strerror(status));
+        emit errorOccured();
+        return;
+    }
+    previous += lead;
+
+    for (int i = 0; i < mBursts.size() && mProcess.load(); ++i)
+    {
+        const auto& burst = mBursts.at(i);
+        const auto timestamp = burst.relative ? previous + burst.timestamp : burst.timestamp;
+        previous = timestamp;
+
+        if (timestamp < end)
+        {
+            qWarning("burst %i overlaps the previous one by %llu samples, skipped",
+                     i, static_cast<unsigned long long>(end - timestamp));
+            ++mBurstsLate;
+            continue;
+        }
+
+        if (int status = waitUntil(timestamp > lead ? timestamp - lead : 0); status != 0)
+        {
+            qWarning("burst stream: failed to get timestamp: %s", bladerf_strerror(status));
+            emit errorOccured();
+            return;
+        }
+        if (!mProcess.load()) break;
+
+        const int status = transmit(burst, timestamp);
+        if (status == BLADERF_ERR_TIME_PAST)
+        {
+            qWarning("burst %i at %llu is late, skipped", i, static_cast<unsigned long long>(timestamp));
+            ++mBurstsLate;
+            continue;
+        }
+        if (status != 0)
+        {
+            qWarning("burst stream error: %s", bladerf_strerror(status));
+            emit errorOccured();
+            return;
+        }
+
+        end = timestamp + burst.count + 1;
+        mSamplesSent += burst.count;
+        ++mBurstsSent;
+    }
+
+    if (!mProcess.load()) return;
+
+    // Let the last burst leave the device before the session is stopped
+    waitUntil(end + lead);
+    qInfo("Bursts: %llu sent, %llu late",
+          static_cast<unsigned long long>(mBurstsSent.load()),
+          static_cast<unsigned long long>(mBurstsLate.load()));
+    emit finished();
+}
+
+int BladeRfBurstStream::transmit(const Burst& burst, bladerf_timestamp timestamp)
+{
+    const quint32 chunk = quint32(mConfig.samplesCount);
+    bladerf_timestamp now = 0;
+    bladerf_metadata meta;
+
+    ExecStatus(bladerf_get_timestamp(mDeviceHandle, BLADERF_TX, &now));
+    if (timestamp <= now) return BLADERF_ERR_TIME_PAST;
+
+    // Bounded submission: at most one buffer per call. The burst ends with a
+    // zero sample so the DAC is not left holding the last value.
+    quint32 offset = 0;
+    for (; offset <= burst.count && mProcess.load(); offset += chunk)
+    {
+        const bool last = burst.count - offset < chunk;
+        quint32 count = std::min(chunk, burst.count - offset);
+        const void* samples = burst.samples + 2 * size_t(offset);
+
+        if (last)
+        {
+            mTail.fill(0, int((count + 1) * SAMPLE_SIZE_BYTES));
+            std::memcpy(mTail.data(), samples, count * SAMPLE_SIZE_BYTES);
+            samples = mTail.constData();
+            ++count;
+        }
+
+        std::memset(&meta, 0, sizeof(meta));
+        if (offset == 0)
+        {
+            meta.flags |= BLADERF_META_FLAG_TX_BURST_START;
+            meta.timestamp = timestamp;
+        }
+        if (last) meta.flags |= BLADERF_META_FLAG_TX_BURST_END;
+
+        ExecStatus(bladerf_sync_tx(mDeviceHandle, samples, count, &meta, SYNC_TIMEOUT_MS));
+    }
+
+    // A stop in the middle of a burst still closes it with the zero sample
+    if (offset != 0 && offset <= burst.count)
+    {
+        const qint16 zero[2] = { 0, 0 };
+
+        std::memset(&meta, 0, sizeof(meta));
+        meta.flags = BLADERF_META_FLAG_TX_BURST_END;
+        ExecStatus(bladerf_sync_tx(mDeviceHandle, zero, 1, &meta, SYNC_TIMEOUT_MS));
+    }
+
+    return 0;
+}
+
+int BladeRfBurstStream::waitUntil(bladerf_timestamp timestamp)
+{
+    bladerf_timestamp now = 0;
+
+    while (mProcess.load())
+    {
+        ExecStatus(bladerf_get_timestamp(mDeviceHandle, BLADERF_TX, &now));
+        if (now >= timestamp) break;
+
+        const auto remainingMs = (timestamp - now) * 1000 / std::max<quint64>(mConfig.sampleRate, 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(std::min<quint64>(remainingMs, MAX_SLEEP_MS)));
+    }
+
+    return 0;
+}
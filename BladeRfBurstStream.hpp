@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QObject>
+#include <QList>
+
+#include <atomic>
+#include <thread>
+
+#include <libbladeRF.h>
+
+#include "Types/MissionConfig.hpp"
+#include "Types/SessionStatistics.hpp"
+
+class QFile;
+
+// Timestamp-scheduled TX on the metadata-enabled sync interface.
+// Every burst is a memory region sent between BURST_START and BURST_END
+// flags, so nothing is transmitted between bursts.
+class BladeRfBurstStream : public QObject
+{
+    Q_OBJECT
+signals:
+    void errorOccured();
+    void finished();
+
+public:
+    struct Burst
+    {
+        const qint16* samples;
+        quint32 count;
+        bladerf_timestamp timestamp;
+        bool relative;
+    };
+
+    BladeRfBurstStream(bladerf* deviceHandle, ushort buffersCount);
+    ~BladeRfBurstStream();
+
+    /// Memory region to send, must stay valid until the stream is stopped
+    void addBurst(const Burst& burst);
+    /// Maps the burst files of the config and appends their repeats
+    int addBursts(const MissionConfig& config);
+
+    int start(const MissionConfig& config, bladerf_channel channel);
+    int stop();
+
+    quint64 burstsSent() const;
+    quint64 burstsLate() const;
+    SessionStatistics statistics() const;
+
+private:
+    void process();
+    int transmit(const Burst& burst, bladerf_timestamp timestamp);
+    int waitUntil(bladerf_timestamp timestamp);
+
+private:
+    bladerf* mDeviceHandle = nullptr;
+    const ushort mBuffersCount;
+    MissionConfig mConfig;
+
+    QList<Burst> mBursts;
+    QList<QFile*> mFiles;
+    QByteArray mTail;
+
+    std::thread* mThread = nullptr;
+    std::atomic_bool mProcess;
+    std::atomic<quint64> mBurstsSent;
+    std::atomic<quint64> mBurstsLate;
+    std::atomic<quint64> mSamplesSent;
+};
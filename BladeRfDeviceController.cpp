@@ -1,12 +1,25 @@
+#include <QFile>
 #include <QDir>
+#include <QElapsedTimer>
 
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+
+#include "Processing/SampleConversion.hpp"
+#include "Processing/SignalStats.hpp"
+#include "Types/FpgaImageCache.hpp"
+#include "Types/PhaseProfile.hpp"
 #include "Types/RawData.hpp"
+#include "Types/SharedMemoryRing.hpp"
 
 #include "BladeRfDeviceController.hpp"
+#include "BladeRfBurstStream.hpp"
 #include "BladeRfStream.hpp"
 
 #define PrintError(message, function)   { int status = function; if (status not_eq 0) { return error(message, status); }
 #define PrintErrorV(message, function)  { int status = function; if (status not_eq 0) { error(message, status); return; } }
+#define StartErrorV(message, function)  { int status = function; if (status not_eq 0) { error(message, status); sessionAbort(); return; } }
 
 #define RX1                             BLADERF_CHANNEL_RX(0)
 #define RX2                             BLADERF_CHANNEL_RX(1)
@@ -14,11 +27,21 @@
 #define TX2                             BLADERF_CHANNEL_TX(1)
 
 #define RX_BUFFERS_COUNT                32
+#define RX_IN_FLIGHT_BUFFERS            (RX_BUFFERS_COUNT / 2)  // submitted transfers
 #define TX_BUFFERS_COUNT                16
 #define RX_CHANNELS_COUNT               2
 #define BLADERF_FOLDER_NAME             "bladeRF"
 #define FPGA_FOLDER_NAME                "fpga"
 #define FPGA_FOLDER_PATH                QDir::currentPath() + '/' + BLADERF_FOLDER_NAME + '/' + FPGA_FOLDER_NAME
+#define TX_STATISTICS_FILE              "tx_session.json"
+#define AGC_LOG_FILE                    "gain_log.csv"
+#define AGC_CLIP_DBFS                   -0.5
+#define SILENCE_DBFS                    -100.0
+#define FPGA_CACHE_PATH                 QDir::currentPath() + '/' + BLADERF_FOLDER_NAME + "/fpga_cache.json"
+#define DEVICE_READY_TIMEOUT_MS         2000
+#define DEVICE_READY_POLL_MS            5
+#define STREAM_READY_TIMEOUT_MS         1000    // on top of one buffer duration
+#define MAX_QUICK_TUNES                 256     // fastlock profiles per direction
 
 inline bool printError(const QString& message, int status)
 {
@@ -43,7 +66,9 @@ BladeRfDeviceController::~BladeRfDeviceController()
 {
     sessionStop();
     if (mTxStream) delete mTxStream;
+    if (mBurstStream) delete mBurstStream;
     if (mRxStream) delete mRxStream;
+    if (mSharedRing) delete mSharedRing;
     deviceClose();
 }
 
@@ -109,13 +134,165 @@ void BladeRfDeviceController::setReferenceClock()
 
 bool BladeRfDeviceController::triggerFire()
 {
-    return printError("rx trigger fire", mRxStream->triggerFire());
+    if (!printError("rx trigger fire", mRxStream->triggerFire()))
+        return false;
+
+    // J51 fire marks an event for pre-trigger captures as well
+    emit eventTriggered();
+    return true;
+}
+
+bool BladeRfDeviceController::retunePrepare(const QList<unsigned long long>& frequencies)
+{
+    // The stream thread reads the cache while a scan runs
+    if (!mScanCenters.isEmpty())
+    {
+        qWarning("Retune preparation refused, a scan is running");
+        return false;
+    }
+
+    QElapsedTimer timer;
+    int prepared = 0;
+
+    timer.start();
+
+    for (const auto channel : tuneChannels())
+    {
+        for (const auto frequency : frequencies)
+        {
+            if (mQuickTunes.contains(qMakePair(channel, frequency))) continue;
+            if (!quickTune(channel, frequency)) return false;
+            ++prepared;
+        }
+
+        // Preparing tunes the hardware, the session frequency is restored
+        const int status = bladerf_set_frequency(mDeviceHandle, channel, mSessionConfig.frequency);
+        if (status not_eq 0) return error("Failed to restore frequency", status, channel);
+    }
+
+    log(QString("%1 quick-tune entries cached in %2 ms").arg(prepared).arg(timer.elapsed()));
+    return true;
+}
+
+bool BladeRfDeviceController::retune(unsigned long long frequency, bladerf_timestamp timestamp)
+{
+    // The stream thread owns the tuning while a scan runs
+    if (!mScanCenters.isEmpty())
+    {
+        qWarning("Retune to %llu refused, a scan is running", frequency);
+        return false;
+    }
+
+    for (const auto channel : tuneChannels())
+    {
+        if (mQuickTunes.contains(qMakePair(channel, frequency))) continue;
+
+        // Slow path: the full tuning is done now, so a timestamp is not honoured
+        log("Frequency " + QString::number(frequency) + " was not prepared", channel);
+        if (!quickTune(channel, frequency)) return false;
+    }
+
+    if (!printError("schedule retune", scheduleRetune(frequency, timestamp))) return false;
+
+    mSessionConfig.frequency = frequency;
+
+    // Capture segments follow the retune. Transfers already in flight hold
+    // samples of the old frequency; a timed retune lands at its timestamp
+    // when the stream has a timestamp base
+    unsigned buffer = mBufferIndex.load() + RX_IN_FLIGHT_BUFFERS;
+    const auto start = mRxStream ? mRxStream->startTimestamp() : 0;
+    if (timestamp not_eq BLADERF_RETUNE_NOW && start && timestamp > start)
+        buffer = unsigned((timestamp - start + mSessionConfig.samplesCount - 1) / mSessionConfig.samplesCount);
+
+    const std::lock_guard<std::mutex> lock(mRxFrequencyMutex);
+    mRxRetunes.append(qMakePair(buffer, frequency));
+    return true;
+}
+
+unsigned long long BladeRfDeviceController::rxFrequency(unsigned index)
+{
+    const std::lock_guard<std::mutex> lock(mRxFrequencyMutex);
+
+    while (!mRxRetunes.isEmpty() && mRxRetunes.first().first <= index)
+        mRxFrequency = mRxRetunes.takeFirst().second;
+
+    return mRxFrequency;
+}
+
+bool BladeRfDeviceController::setGain(int value)
+{
+    QList<bladerf_channel> channels;
+
+    if (mSessionConfig.direction != Direction::TX) channels << RX1 << RX2;
+    if (mSessionConfig.direction != Direction::RX) channels << (mSessionConfig.channel == Channel::One ? TX1 : TX2);
+
+    // Every channel is checked before any is changed
+    for (const auto channel : channels)
+    {
+        const bladerf_range* range = nullptr;
+        if (!printError("get gain range", bladerf_get_gain_range(mDeviceHandle, channel, &range))) return false;
+
+        if (value < range->min * range->scale || value > range->max * range->scale)
+        {
+            qWarning("Gain %d is outside %.0f..%.0f dB of %s", value,
+                     range->min * range->scale, range->max * range->scale, qPrintable(moduleToString(channel)));
+            return false;
+        }
+    }
+
+    for (const auto channel : channels)
+        if (!printError("set gain " + QString::number(value), bladerf_set_gain(mDeviceHandle, channel, value)))
+            return false;
+
+    mSessionConfig.gain = value;
+
+    // A manual change is where the AGC continues from
+    if (mAgcLog)
+    {
+        mAgcGain.fill(value);
+        mAgcSettleSamples.store(quint64(RX_IN_FLIGHT_BUFFERS) * mSessionConfig.samplesCount);
+        for (int i = 0; i < RX_CHANNELS_COUNT; ++i)
+            agcLog(i, value);
+    }
+    return true;
+}
+
+bool BladeRfDeviceController::setTxGain(double gainDb)
+{
+    if (!mTxStream || !mTxStream->setTxGain(gainDb)) return false;
+
+    mSessionConfig.txGainDb = gainDb;
+    return true;
+}
+
+QJsonObject BladeRfDeviceController::status() const
+{
+    QJsonObject json;
+
+    json["running"] = mCaptureProcessFlag.load();
+    json["direction"] = int(mSessionConfig.direction);
+    json["frequency"] = QString::number(mSessionConfig.frequency);
+    json["gain"] = int(mSessionConfig.gain);
+    json["buffers"] = qint64(mBufferIndex.load());
+
+    // Counters only, the stream thread may be appending underrun events
+    if (mTxStream)
+    {
+        const auto& statistics = mTxStream->statistics();
+        json["tx_samples_sent"] = QString::number(statistics.samplesSent);
+        json["tx_underruns"] = QString::number(statistics.underruns);
+    }
+
+    return json;
 }
 
 void BladeRfDeviceController::deviceOpen(const bladerf_devinfo deviceInfo)
 {
+    PhaseProfile profile;
     int status = 0;
 
+    profile.start();
+
     mDeviceInfo = deviceInfo;
     memcpy(mDeviceInfo.manufacturer, deviceInfo.manufacturer, strlen(deviceInfo.manufacturer));
     memcpy(mDeviceInfo.product, deviceInfo.product, strlen(deviceInfo.product));
@@ -134,38 +311,59 @@ void BladeRfDeviceController::deviceOpen(const bladerf_devinfo deviceInfo)
         }
     }
 
+    profile.mark("open");
+
     {   // FPGA load
-        if (status = bladerf_is_fpga_configured(mDeviceHandle); status != 1)
+        const bool configured = bladerf_is_fpga_configured(mDeviceHandle) == 1;
+        const QString serial(mDeviceInfo.serial);
+        FpgaImageCache cache(FPGA_CACHE_PATH);
+        size_t size = 0;
+
+        if (status = bladerf_get_fpga_bytes(mDeviceHandle, &size); status < 0)
+        {
+            error("Failed to determine FPGA image size", status);
+            deviceClose();
+            return;
+        }
+        profile.mark("fpga check");
+
+        // An image replaced on disk is loaded again even into a configured FPGA
+        const bool changed = cache.changed(serial, size);
+        if (configured && !changed) qDebug("FPGA loaded");
+        else
         {
-            const QDir fpgaDir(FPGA_FOLDER_PATH);
-            const auto fpgaFiles = fpgaDir.entryList(QDir::Files);
-            size_t size = 0;
+            if (changed) log(QString("%1 changed on disk").arg(QFileInfo(cache.lastImage(serial, size)).fileName()));
+
+            auto image = cache.image(serial, size);
 
-            if (status = bladerf_get_fpga_bytes(mDeviceHandle, &size); status < 0)
+            if (image.isEmpty())
             {
-                error("Failed to determine FPGA image size", status);
-                deviceClose();
-                return;
+                const QDir fpgaDir(FPGA_FOLDER_PATH);
+
+                for (const auto& entry : fpgaDir.entryList(QDir::Files))
+                {
+                    const auto entryPath = fpgaDir.absoluteFilePath(entry);
+                    if (QFileInfo(entryPath).size() != qint64(size)) continue;
+
+                    image = entryPath;
+                    break;
+                }
+                profile.mark("fpga scan");
             }
 
-            for (const auto& entry : fpgaFiles)
+            if (!image.isEmpty())
             {
-                const auto entryPath = fpgaDir.absoluteFilePath(entry);
-
-                if (QFileInfo(entryPath).size() == size)
+                if (status = bladerf_load_fpga(mDeviceHandle, image.toUtf8()); status < 0)
                 {
-                    if (status = bladerf_load_fpga(mDeviceHandle, entryPath.toUtf8()); status < 0)
-                    {
-                        error("Failed to load FPGA image", status);
-                        deviceClose();
-                        return;
-                    }
-                    else
-                    {
-                        log(QString("%1 fpga loaded").arg(entry));
-                        break;
-                    }
+                    error("Failed to load FPGA image", status);
+                    deviceClose();
+                    return;
                 }
+
+                log(QString("%1 fpga loaded").arg(QFileInfo(image).fileName()));
+                cache.store(serial, size, image);
+                if (!cache.save()) qWarning("Can't save FPGA image cache");
+                profile.mark("fpga load");
             }
 
             status = bladerf_is_fpga_configured(mDeviceHandle);
@@ -182,10 +380,16 @@ void BladeRfDeviceController::deviceOpen(const bladerf_devinfo deviceInfo)
                 return;
             }
         }
-        else qDebug("FPGA loaded");
     }
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    if (!waitDeviceReady())
+    {
+        deviceClose();
+        return;
+    }
+    profile.mark("ready");
+
+    qInfo("Device open: %s", qPrintable(profile.summary()));
 
     //setReferenceClock();
 
@@ -194,92 +398,258 @@ void BladeRfDeviceController::deviceOpen(const bladerf_devinfo deviceInfo)
 
 void BladeRfDeviceController::sessionStart(const MissionConfig& config)
 {
-    BladeRfStream* stream = nullptr;
-    bladerf_channel_layout layout = bladerf_channel_layout::BLADERF_RX_X1;
-    bladerf_direction direction = bladerf_direction::BLADERF_RX;
-    bladerf_channel channel = 0;
+    const bladerf_channel channel = config.channel == Channel::One ? TX1 : TX2;
+    PhaseProfile profile;
 
+    profile.start();
     mSessionConfig = config;
+    mBufferIndex = 0;
+    {
+        const std::lock_guard<std::mutex> lock(mRxFrequencyMutex);
+        mRxFrequency = 0;
+        mRxRetunes.clear();
+    }
+
+    // Streams of a previous session
+    if (mRxStream) delete mRxStream;
+    if (mTxStream) delete mTxStream;
+    if (mBurstStream) delete mBurstStream;
+    mRxStream = mTxStream = nullptr;
+    mBurstStream = nullptr;
+
+    mScanCenters.clear();
+    if (config.scan.enabled()) mSessionConfig.frequency = config.scan.centers().first();
 
     switch (config.direction)
     {
         case Direction::RX:
-        {
-            stream = mRxStream = new BladeRfStream(mDeviceHandle, BLADERF_RX, RX_BUFFERS_COUNT);
-
-            connect(mRxStream, &BladeRfStream::data,
-                    this,      &BladeRfDeviceController::onRxCaptureAvailable,
-                    Qt::QueuedConnection);
-            connect(mRxStream, &BladeRfStream::errorOccured,
-                    this,      &BladeRfDeviceController::errorOccured,
-                    Qt::QueuedConnection);
-
-            direction = BLADERF_RX;
-            layout = BLADERF_RX_X2;
-
-            if (!moduleSetup(direction, RX1)
-            ||  !moduleSetup(direction, RX2)
-            ||  !moduleState(RX1, true)
-            ||  !moduleState(RX2, true)
-            ||  !moduleGain(RX1, config.gain)
-            ||  !moduleGain(RX2, config.gain))
+            if (!rxSessionSetup(mSessionConfig)) return;
+            profile.mark("rx setup");
+            if (config.scan.enabled() && !scanStart(config))
             {
-                sessionStop();
+                sessionAbort();
                 return;
             }
-        }
+
+            // A start offset counts from the edge, which J51-1 also carries
+            // out to other equipment
+            if (config.rxStartOffset)
+                StartErrorV("rx trigger arm", mRxStream->triggerArm(BLADERF_TRIGGER_ROLE_MASTER));
         break;
         case Direction::TX:
-        {
-            stream = mTxStream = new BladeRfStream(mDeviceHandle, BLADERF_TX, TX_BUFFERS_COUNT);
+            if (!txSessionSetup(config, channel)) return;
+            profile.mark("tx setup");
+        break;
+        case Direction::Duplex:
+            if (!rxSessionSetup(config)) return;
+            profile.mark("rx setup");
+            if (!txSessionSetup(config, channel)) return;
+            profile.mark("tx setup");
+
+            // Both streams hold their samples until the RX master trigger fires,
+            // the TX slave listens to the same J51-1 line
+            StartErrorV("rx trigger arm", mRxStream->triggerArm(BLADERF_TRIGGER_ROLE_MASTER));
+            StartErrorV("tx trigger arm", mTxStream->triggerArm(BLADERF_TRIGGER_ROLE_SLAVE));
+        break;
+    }
 
-            connect(mTxStream, &BladeRfStream::errorOccured,
-                    this,      &BladeRfDeviceController::errorOccured,
-                    Qt::QueuedConnection);
+    if (mSessionConfig.agc.enabled && !agcStart())
+    {
+        sessionAbort();
+        return;
+    }
 
-            direction = BLADERF_TX;
-            layout = BLADERF_TX_X1;
-            channel = config.channel == Channel::One ? TX1 : TX2;
+    // Buffers are taken from the first one on, startup no longer drops any
+    mCaptureProcessFlag.store(true);
 
-            if (!moduleSetup(direction, channel)
-            ||  !moduleState(channel, true)
-            ||  !moduleGain(channel, config.gain))
-            {
-                sessionStop();
-                return;
-            }
-        }
-        break;
+    if (mRxStream)
+    {
+        // The RX_X2 buffer holds samplesCount samples of both channels
+        StartErrorV("rx stream init", mRxStream->streamInit(config, RX_CHANNELS_COUNT));
+        profile.mark("rx stream init");
+        StartErrorV("rx stream start", mRxStream->streamStart(BLADERF_RX_X2));
+        profile.mark("rx stream start");
     }
 
-    PrintErrorV("stream init", stream->streamInit(config));
-    PrintErrorV("stream start", stream->streamStart(layout));
+    if (mTxStream)
+    {
+        StartErrorV("tx stream init", mTxStream->streamInit(config));
+        profile.mark("tx stream init");
+        StartErrorV("tx stream start", mTxStream->streamStart(BLADERF_TX_X1));
+        profile.mark("tx stream start");
+    }
+    else if (mBurstStream)
+    {
+        StartErrorV("burst files", mBurstStream->addBursts(config));
+        StartErrorV("burst stream start", mBurstStream->start(config, channel));
+    }
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    if (config.direction == Direction::Duplex)
+    {
+        // The TX pre-roll is in place once streamStart returned, so RX buffer 0
+        // and TX sample 0 start on the same clock edge
+        StartErrorV("duplex trigger fire", mRxStream->triggerFire());
+        log("Duplex streams started on a shared trigger");
+    }
+    else if (mRxStream && config.rxStartOffset)
+    {
+        StartErrorV("rx trigger fire", mRxStream->triggerFire());
+        log("RX stream started on the trigger, recording " + QString::number(config.rxStartOffset) + " samples past the edge");
+    }
 
-    mCaptureProcessFlag.store(true);
+    {   // started once samples actually move
+        const unsigned timeout = STREAM_READY_TIMEOUT_MS + 1000ull * config.samplesCount / config.sampleRate;
+
+        if (mRxStream) StartErrorV("rx stream ready", mRxStream->streamWaitStarted(timeout));
+        if (mTxStream) StartErrorV("tx stream ready", mTxStream->streamWaitStarted(timeout));
+        if (mRxStream || mTxStream) profile.mark("first buffer");
+    }
+
+    qInfo("Session start: %s", qPrintable(profile.summary()));
     emit sessionStarted();
 }
 
+bool BladeRfDeviceController::rxSessionSetup(const MissionConfig& config)
+{
+    mRxStream = new BladeRfStream(mDeviceHandle, BLADERF_RX, RX_BUFFERS_COUNT);
+
+    // Handled on the stream thread: the buffer is only valid until the callback
+    // returns, and a blocking writer queue has to hold back the stream itself
+    connect(mRxStream, &BladeRfStream::data,
+            this,      &BladeRfDeviceController::onRxCaptureAvailable,
+            Qt::DirectConnection);
+    connect(mRxStream, &BladeRfStream::errorOccured,
+            this,      &BladeRfDeviceController::errorOccured,
+            Qt::QueuedConnection);
+
+    if (!moduleSetup(BLADERF_RX, RX1)
+    ||  !moduleSetup(BLADERF_RX, RX2)
+    ||  !moduleState(RX1, true)
+    ||  !moduleState(RX2, true)
+    ||  !moduleGain(RX1, config.gain)
+    ||  !moduleGain(RX2, config.gain))
+    {
+        sessionStop();
+        return false;
+    }
+
+    if (!config.shmName.isEmpty())
+    {
+        if (!mSharedRing) mSharedRing = new SharedMemoryRing;
+
+        if (mSharedRing->create(qPrintable(config.shmName), config.shmSlots,
+                                config.samplesCount * SAMPLE_SIZE_BYTES, config.sampleRate))
+            log("Publishing to shared memory " + config.shmName);
+        else
+            qWarning("Failed to create shared memory ring %s: %s",
+                     qPrintable(config.shmName), strerror(errno));
+    }
+
+    return true;
+}
+
+bool BladeRfDeviceController::txSessionSetup(const MissionConfig& config, bladerf_channel channel)
+{
+    if (config.bursts.isEmpty())
+    {
+        mTxStream = new BladeRfStream(mDeviceHandle, BLADERF_TX, TX_BUFFERS_COUNT);
+
+        connect(mTxStream, &BladeRfStream::errorOccured,
+                this,      &BladeRfDeviceController::errorOccured,
+                Qt::QueuedConnection);
+        connect(mTxStream, &BladeRfStream::finished,
+                this,      &BladeRfDeviceController::sessionStop,
+                Qt::QueuedConnection);
+    }
+    else
+    {
+        mBurstStream = new BladeRfBurstStream(mDeviceHandle, TX_BUFFERS_COUNT);
+
+        connect(mBurstStream, &BladeRfBurstStream::errorOccured,
+                this,         &BladeRfDeviceController::errorOccured,
+                Qt::QueuedConnection);
+        connect(mBurstStream, &BladeRfBurstStream::finished,
+                this,         &BladeRfDeviceController::sessionStop,
+                Qt::QueuedConnection);
+    }
+
+    if (!moduleSetup(BLADERF_TX, channel)
+    ||  !moduleState(channel, true)
+    ||  !moduleGain(channel, config.gain))
+    {
+        sessionStop();
+        return false;
+    }
+
+    return true;
+}
+
 void BladeRfDeviceController::sessionStop()
 {
     if (mTxStream)
     {
-        PrintErrorV("tx stream stop", mTxStream->streamStop());
-        PrintErrorV("tx trigger disarm", mTxStream->triggerDisarm());
-        PrintErrorV("tx stream deinit", mTxStream->streamDeinit());
+        printError("tx stream stop", mTxStream->streamStop());
+        printError("tx trigger disarm", mTxStream->triggerDisarm());
+        printError("tx stream deinit", mTxStream->streamDeinit());
+    }
+    if (mBurstStream)
+    {
+        printError("burst stream stop", mBurstStream->stop());
     }
     if (mRxStream)
     {
-        PrintErrorV("rx stream stop", mRxStream->streamStop());
-        PrintErrorV("rx trigger disarm", mRxStream->triggerDisarm());
-        PrintErrorV("rx stream deinit", mRxStream->streamDeinit());
+        printError("rx stream stop", mRxStream->streamStop());
+        printError("rx trigger disarm", mRxStream->triggerDisarm());
+        printError("rx stream deinit", mRxStream->streamDeinit());
+    }
+    if (mSharedRing) mSharedRing->close();
+
+    if (mAgcLog)
+    {
+        delete mAgcLog;
+        mAgcLog = nullptr;
+    }
+
+    if (mCaptureProcessFlag.load())
+    {
+        if (mBurstStream) saveTxStatistics(mBurstStream->statistics());
+        if (mTxStream) saveTxStatistics(mTxStream->statistics());
     }
 
     mCaptureProcessFlag.store(false);
     emit sessionStopped();
 }
 
+void BladeRfDeviceController::sessionAbort()
+{
+    // Nothing was sent or recorded worth a summary, whatever started is stopped
+    mCaptureProcessFlag.store(false);
+    sessionStop();
+}
+
+void BladeRfDeviceController::saveTxStatistics(const SessionStatistics& statistics)
+{
+    QFile file(mSessionConfig.outputPath(TX_STATISTICS_FILE));
+
+    if (statistics.clean())
+        qInfo("TX clean: %llu samples sent, low watermark %u of %u samples",
+              statistics.samplesSent, statistics.lowWatermark, statistics.capacity);
+    else
+        qWarning("TX not clean: %llu underruns (%llu samples), %llu late bursts",
+                 statistics.underruns, statistics.underrunSamples, statistics.burstsLate);
+
+    if (statistics.clippedValues)
+        qWarning("TX clipped %llu values, peak %.1f dBFS, crest factor %.1f dB",
+                 statistics.clippedValues, statistics.peakDbfs, statistics.crestFactorDb);
+
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning("Can't save tx statistics: %s", qPrintable(file.errorString()));
+        return;
+    }
+    file.write(statistics.raw(QJsonDocument::Indented));
+}
+
 bool BladeRfDeviceController::error(const QString& message, int bladerf_error, bladerf_channel module)
 {
     if (module != BladeRFUndefined)
@@ -329,6 +699,8 @@ void BladeRfDeviceController::deviceClose()
     {
         bladerf_close(mDeviceHandle);
         mDeviceHandle = nullptr;
+        mQuickTunes.clear();
+        mQuickTuneOrder.clear();
         emit closed();
     }
 }
@@ -416,6 +788,300 @@ bool BladeRfDeviceController::moduleGain(bladerf_module module, int value)
     return true;
 }
 
+QList<bladerf_channel> BladeRfDeviceController::tuneChannels() const
+{
+    const bladerf_channel tx = mSessionConfig.channel == Channel::One ? TX1 : TX2;
+
+    // RX1 and RX2 share one LO, as do TX1 and TX2
+    switch (mSessionConfig.direction)
+    {
+        case Direction::RX: return { RX1 };
+        case Direction::TX: return { tx };
+        case Direction::Duplex: return { RX1, tx };
+    }
+    return {};
+}
+
+bool BladeRfDeviceController::quickTune(bladerf_channel channel, unsigned long long frequency)
+{
+    bladerf_quick_tune tune;
+
+    // Failures are reported only, a bad frequency must not end the session
+    if (!printError("set frequency " + QString::number(frequency), bladerf_set_frequency(mDeviceHandle, channel, frequency))
+    ||  !printError("read quick tune", bladerf_get_quick_tune(mDeviceHandle, channel, &tune)))
+        return false;
+
+    const auto key = qMakePair(channel, frequency);
+    if (!mQuickTunes.contains(key))
+    {
+        // Past the profile count the FPGA reuses slots, the oldest entry of the channel goes
+        int channelTunes = 0;
+        for (const auto& cached : mQuickTuneOrder)
+            if (cached.first == channel) ++channelTunes;
+
+        if (channelTunes >= MAX_QUICK_TUNES)
+        {
+            for (int i = 0; i < mQuickTuneOrder.size(); ++i)
+            {
+                if (mQuickTuneOrder.at(i).first not_eq channel) continue;
+                mQuickTunes.remove(mQuickTuneOrder.takeAt(i));
+                break;
+            }
+        }
+
+        mQuickTuneOrder.append(key);
+    }
+
+    mQuickTunes.insert(key, tune);
+    return true;
+}
+
+int BladeRfDeviceController::scheduleRetune(unsigned long long frequency, bladerf_timestamp timestamp)
+{
+    for (const auto channel : tuneChannels())
+    {
+        auto tune = mQuickTunes.value(qMakePair(channel, frequency));
+
+        const int status = bladerf_schedule_retune(mDeviceHandle, channel, timestamp, 0, &tune);
+        if (status not_eq 0) return status;
+    }
+
+    return 0;
+}
+
+bool BladeRfDeviceController::scanStart(const MissionConfig& config)
+{
+    const auto samplesCount = double(config.samplesCount);
+    const auto centers = config.scan.centers();
+
+    // Prepared before the scan owns the cache, retunePrepare refuses during a scan
+    if (!retunePrepare(centers)) return false;
+
+    mScanCenters = centers;
+    mScanIndex = 0;
+    mScanSweeps = 0;
+    mScanBuffer = 0;
+    mScanFinished = false;
+
+    // Transfers already in flight may hold samples of the previous frequency
+    mSettleBuffers = RX_BUFFERS_COUNT / 2 + unsigned(std::ceil(config.scan.settle * config.sampleRate / samplesCount));
+    mDwellBuffers = std::max(1u, unsigned(std::ceil(config.scan.dwell * config.sampleRate / samplesCount)));
+
+    log(QString("Scan over %1 frequencies, %2 buffers dwell, %3 buffers settle")
+            .arg(mScanCenters.size()).arg(mDwellBuffers).arg(mSettleBuffers));
+    return true;
+}
+
+bool BladeRfDeviceController::scanAccept()
+{
+    if (mScanFinished) return false;
+    if (mScanBuffer++ < mSettleBuffers) return false;
+    if (mScanBuffer < mSettleBuffers + mDwellBuffers) return true;
+
+    // Last buffer of the dwell: it is captured already, the next one is not
+    mScanBuffer = 0;
+    if (++mScanIndex == mScanCenters.size())
+    {
+        mScanIndex = 0;
+        if (mSessionConfig.scan.sweeps && ++mScanSweeps == unsigned(mSessionConfig.scan.sweeps))
+        {
+            mScanFinished = true;
+            log(QString("Scan finished after %1 sweeps").arg(mScanSweeps));
+            QMetaObject::invokeMethod(this, &BladeRfDeviceController::sessionStop, Qt::QueuedConnection);
+            return true;
+        }
+    }
+
+    const int status = scheduleRetune(mScanCenters[mScanIndex], BLADERF_RETUNE_NOW);
+    if (status not_eq 0)
+        qWarning("Scan retune to %llu failed: %s", mScanCenters[mScanIndex], bladerf_strerror(status));
+
+    return true;
+}
+
+void BladeRfDeviceController::dutyCycleAccept(qint16* buffer, unsigned index, unsigned long long frequency)
+{
+    const quint64 samplesCount = mSessionConfig.samplesCount;
+    const quint64 period = mSessionConfig.dutyOn + mSessionConfig.dutyOff;
+    const quint64 first = quint64(index) * samplesCount;
+    const quint64 last = first + samplesCount;
+    const auto timestamp = mRxStream->startTimestamp();
+
+    // Windows are counted from stream sample 0, off samples are never touched
+    for (quint64 position = first; position < last;)
+    {
+        const quint64 phase = position % period;
+        if (phase >= mSessionConfig.dutyOn)
+        {
+            position += period - phase;
+            continue;
+        }
+
+        const quint64 end = std::min<quint64>(last, position + mSessionConfig.dutyOn - phase);
+        const unsigned length = end - position;
+        const auto part = buffer + 4 * (position - first);     // I/Q of both channels per sample
+
+        bladerf_deinterleave_stream_buffer(BLADERF_RX_X2,
+                                           BLADERF_FORMAT_SC16_Q11,
+                                           RX_CHANNELS_COUNT * length,
+                                           part);
+
+        if (mSessionConfig.agc.enabled) agcMeasure(part, length);
+
+        if (mSharedRing)
+            mSharedRing->publish(part, part + 2 * length, length * SAMPLE_SIZE_BYTES, position, index);
+
+        RawData data(part, length);
+        data.setIndex(index);
+        data.setFrequency(frequency);
+        data.setSampleOffset(position);
+        if (timestamp) data.setTimestamp(timestamp + position);
+
+        emit rxDataAvailable(data);
+        position = end;
+    }
+}
+
+bool BladeRfDeviceController::agcStart()
+{
+    mAgcSamples = 0;
+    mAgcWindow = std::max<quint64>(mSessionConfig.agc.interval * mSessionConfig.sampleRate, 1);
+    mAgcPowerSum.fill(0);
+    mAgcPeakPower.fill(0);
+    mAgcSettleSamples.store(0);
+    mAgcGain.fill(std::clamp<int>(mSessionConfig.gain, mSessionConfig.agc.minGain, mSessionConfig.agc.maxGain));
+
+    for (int i = 0; i < RX_CHANNELS_COUNT; ++i)
+        if (!moduleGain(BLADERF_CHANNEL_RX(i), mAgcGain[i])) return false;
+
+    mAgcLog = new QFile(mSessionConfig.outputPath(AGC_LOG_FILE));
+    if (!mAgcLog->open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        qWarning("Can't open gain log: %s", qPrintable(mAgcLog->errorString()));
+        return false;
+    }
+
+    // The first rows are the starting gains
+    mAgcLog->write("sample_offset,earliest_offset,timestamp,channel,gain\n");
+    for (int i = 0; i < RX_CHANNELS_COUNT; ++i)
+        agcLog(i, mAgcGain[i]);
+
+    log(QString("AGC to %1 dBFS every %2 s").arg(mSessionConfig.agc.target).arg(mSessionConfig.agc.interval));
+    return true;
+}
+
+void BladeRfDeviceController::agcMeasure(const qint16* samples, unsigned samplesCount)
+{
+    // Buffers in flight when the gain changed are a mix of both gains,
+    // the window starts over after them
+    quint64 settle = mAgcSettleSamples.load();
+    while (settle && !mAgcSettleSamples.compare_exchange_weak(settle, settle > samplesCount ? settle - samplesCount : 0));
+    if (settle)
+    {
+        mAgcSamples = 0;
+        mAgcPowerSum.fill(0);
+        mAgcPeakPower.fill(0);
+        return;
+    }
+
+    // Deinterleaved: RX1 followed by RX2
+    for (int i = 0; i < RX_CHANNELS_COUNT; ++i)
+        SignalStats::power(samples + 2 * size_t(samplesCount) * i, samplesCount, mAgcPowerSum[i], mAgcPeakPower[i]);
+
+    mAgcSamples += samplesCount;
+    if (mAgcSamples < mAgcWindow) return;
+
+    const double fullScale = double(SC16_Q11_MAX) * SC16_Q11_MAX;
+    std::array<double, 2> peak, rms;
+
+    for (int i = 0; i < RX_CHANNELS_COUNT; ++i)
+    {
+        peak[i] = mAgcPeakPower[i] ? 10 * std::log10(mAgcPeakPower[i] / fullScale) : SILENCE_DBFS;
+        rms[i] = mAgcPowerSum[i] ? 10 * std::log10(mAgcPowerSum[i] / (fullScale * mAgcSamples)) : SILENCE_DBFS;
+    }
+
+    mAgcSamples = 0;
+    mAgcPowerSum.fill(0);
+    mAgcPeakPower.fill(0);
+
+    QMetaObject::invokeMethod(this, [this, peak, rms]() { agcUpdate(peak, rms); }, Qt::QueuedConnection);
+}
+
+void BladeRfDeviceController::agcUpdate(const std::array<double, 2>& peakDbfs, const std::array<double, 2>& rmsDbfs)
+{
+    const auto& agc = mSessionConfig.agc;
+    if (!mCaptureProcessFlag.load() || !mAgcLog) return;
+
+    for (int i = 0; i < RX_CHANNELS_COUNT; ++i)
+    {
+        const double error = agc.target - peakDbfs[i];
+        int step = 0;
+
+        if (peakDbfs[i] >= AGC_CLIP_DBFS) step = -agc.maxStep;
+        else if (std::abs(error) > agc.hysteresis) step = std::clamp<int>(std::lround(error), -agc.maxStep, agc.maxStep);
+
+        const int gain = std::clamp(mAgcGain[i] + step, agc.minGain, agc.maxGain);
+        if (gain == mAgcGain[i]) continue;
+
+        const auto channel = BLADERF_CHANNEL_RX(i);
+        if (!printError("agc set gain", bladerf_set_gain(mDeviceHandle, channel, gain))) continue;
+
+        mAgcGain[i] = gain;
+        mAgcSettleSamples.store(quint64(RX_IN_FLIGHT_BUFFERS) * mSessionConfig.samplesCount);
+
+        log(QString("AGC gain %1 dB (peak %2 dBFS, rms %3 dBFS)")
+                .arg(gain).arg(peakDbfs[i], 0, 'f', 1).arg(rmsDbfs[i], 0, 'f', 1), channel);
+        agcLog(i, gain);
+    }
+}
+
+void BladeRfDeviceController::agcLog(int channel, int gain)
+{
+    // The change lands after the samples received so far and, at the latest,
+    // after the transfers in flight; before the stream starts it lands at 0
+    const quint64 earliest = quint64(mBufferIndex.load()) * mSessionConfig.samplesCount;
+    const quint64 inFlight = mCaptureProcessFlag.load() ? quint64(RX_IN_FLIGHT_BUFFERS) * mSessionConfig.samplesCount : 0;
+    const quint64 offset = earliest + inFlight;
+    const auto timestamp = mRxStream ? mRxStream->startTimestamp() : 0;
+
+    mAgcLog->write(QString("%1,%2,%3,%4,%5\n")
+                       .arg(offset)
+                       .arg(earliest)
+                       .arg(timestamp ? QString::number(timestamp + offset) : QString())
+                       .arg(channel + 1)
+                       .arg(gain)
+                       .toUtf8());
+    mAgcLog->flush();
+}
+
+bool BladeRfDeviceController::waitDeviceReady()
+{
+    QElapsedTimer timer;
+    int status = 0;
+
+    timer.start();
+
+    // The FPGA reports configured before the RFIC is initialised, the RFIC
+    // answers once it is; boards without an RFIC query are ready with the FPGA
+    while (timer.elapsed() < DEVICE_READY_TIMEOUT_MS)
+    {
+        float temperature = 0;
+
+        status = bladerf_is_fpga_configured(mDeviceHandle);
+        if (status < 0) return error("Failed to determine FPGA state", status);
+
+        if (status == 1)
+        {
+            status = bladerf_get_rfic_temperature(mDeviceHandle, &temperature);
+            if (status == 0 || status == BLADERF_ERR_UNSUPPORTED) return true;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(DEVICE_READY_POLL_MS));
+    }
+
+    return error("Device not ready", status < 0 ? status : BLADERF_ERR_TIMEOUT);
+}
+
 void BladeRfDeviceController::deviceSilentReopen()
 {
     blockSignals(true);
@@ -424,15 +1090,39 @@ void BladeRfDeviceController::deviceSilentReopen()
     blockSignals(false);
 }
 
-void BladeRfDeviceController::onRxCaptureAvailable(qint16* buffer, unsigned short samplesCount)
+void BladeRfDeviceController::onRxCaptureAvailable(qint16* buffer, unsigned samplesCount)
 {
     if (!mCaptureProcessFlag.load()) return; // In the end of capture session
                                              //   it can enter here and crash. Why?
 
+    // Settling buffers of a scan are dropped, their index is skipped
+    const auto index = mBufferIndex++;
+    const auto frequency = mScanCenters.isEmpty() ? rxFrequency(index) : mScanCenters[mScanIndex];
+    if (!mScanCenters.isEmpty() && !scanAccept()) return;
+
+    if (mSessionConfig.dutyOn)
+    {
+        dutyCycleAccept(buffer, index, frequency);
+        return;
+    }
+
     bladerf_deinterleave_stream_buffer(BLADERF_RX_X2,
                                        BLADERF_FORMAT_SC16_Q11,
                                        samplesCount,
                                        buffer);
 
-    emit rxDataAvailable(RawData(buffer, mSessionConfig.samplesCount));
+    if (mSessionConfig.agc.enabled) agcMeasure(buffer, mSessionConfig.samplesCount);
+
+    if (mSharedRing)
+        mSharedRing->publish(buffer,
+                             buffer + mSessionConfig.samplesCount * 2,
+                             mSessionConfig.samplesCount * SAMPLE_SIZE_BYTES,
+                             quint64(index) * mSessionConfig.samplesCount,
+                             index);
+
+    RawData data(buffer, mSessionConfig.samplesCount);
+    data.setIndex(index);
+    data.setFrequency(frequency);
+
+    emit rxDataAvailable(data);
 }
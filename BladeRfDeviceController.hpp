@@ -1,6 +1,11 @@
 #pragma once
 
 #include <QObject>
+#include <QHash>
+#include <QPair>
+
+#include <array>
+#include <mutex>
 
 #include <libbladeRF.h>
 
@@ -17,8 +22,12 @@
     #endif
 #endif
 
+class QFile;
+class BladeRfBurstStream;
 class BladeRfStream;
 class RawData;
+class SessionStatistics;
+class SharedMemoryRing;
 
 class BladeRfDeviceController : public QObject
 {
@@ -30,6 +39,7 @@ signals:
     void sessionStarted();
     void sessionStopped();
     void rxDataAvailable(const RawData& data);
+    void eventTriggered();
 
 public:
     explicit BladeRfDeviceController(QObject* parent = nullptr);
@@ -42,6 +52,17 @@ public:
     bool triggerFire();
     void printAboutDevice();
 
+    /// Caches quick-tune entries of the session channels for every frequency
+    bool retunePrepare(const QList<unsigned long long>& frequencies);
+    /// Moves the session channels to frequency at a device timestamp, or right away
+    bool retune(unsigned long long frequency, bladerf_timestamp timestamp = BLADERF_RETUNE_NOW);
+    /// Changes the gain of the session channels while streaming
+    bool setGain(int value);
+    /// Changes the digital gain of the TX stream while streaming
+    bool setTxGain(double gainDb);
+    /// Session state and counters, compact enough for the control socket
+    QJsonObject status() const;
+
 public slots:
     void deviceOpen(const bladerf_devinfo deviceInfo);
     void deviceClose();
@@ -55,14 +76,43 @@ private:
 
     QString moduleToString(bladerf_channel module) const;
 
+    /// A failed session start: stops whatever started, without a TX summary
+    void sessionAbort();
+
     bool moduleSetup(bladerf_direction direction, bladerf_module module);
     bool moduleState(bladerf_module module, bool state);
     bool moduleGain(bladerf_module module, int value);
 
+    QList<bladerf_channel> tuneChannels() const;
+    bool quickTune(bladerf_channel channel, unsigned long long frequency);
+    int scheduleRetune(unsigned long long frequency, bladerf_timestamp timestamp);
+    /// Stream thread: frequency of an RX buffer after live retunes, 0 - the session one
+    unsigned long long rxFrequency(unsigned index);
+
+    bool scanStart(const MissionConfig& config);
+    /// Called per RX buffer, false for settling buffers; retunes after the last one of a dwell
+    bool scanAccept();
+    /// Deinterleaves and hands out only the parts of the buffer inside duty windows
+    void dutyCycleAccept(qint16* buffer, unsigned index, unsigned long long frequency);
+
+    bool agcStart();
+    /// Stream thread: accumulates the level of deinterleaved samples, posts it once per interval
+    void agcMeasure(const qint16* samples, unsigned samplesCount);
+    /// Controller thread: one control step per channel
+    void agcUpdate(const std::array<double, 2>& peakDbfs, const std::array<double, 2>& rmsDbfs);
+    /// Gain change row of the gain log, channel from 0
+    void agcLog(int channel, int gain);
+
+    bool rxSessionSetup(const MissionConfig& config);
+    bool txSessionSetup(const MissionConfig& config, bladerf_channel channel);
+
+    /// Polls the FPGA and the RFIC until they accept commands
+    bool waitDeviceReady();
     void deviceSilentReopen();
+    void saveTxStatistics(const SessionStatistics& statistics);
 
 private slots:
-    void onRxCaptureAvailable(qint16* buffer, unsigned short samplesCount);
+    void onRxCaptureAvailable(qint16* buffer, unsigned samplesCount);
 
 private:
     MissionConfig mSessionConfig;
@@ -71,7 +121,38 @@ private:
     bladerf* mDeviceHandle = nullptr;
 
     std::atomic_bool mCaptureProcessFlag;
+    std::atomic_uint mBufferIndex { 0 };   // read by status() and the AGC log
+    // Live retunes, stamped on RX buffers from the first one at the new frequency
+    std::mutex mRxFrequencyMutex;
+    unsigned long long mRxFrequency = 0;
+    QList<QPair<unsigned, unsigned long long>> mRxRetunes;     // first buffer, frequency
 
     BladeRfStream* mRxStream = nullptr;
     BladeRfStream* mTxStream = nullptr;
+    BladeRfBurstStream* mBurstStream = nullptr;
+
+    SharedMemoryRing* mSharedRing = nullptr;
+
+    // Scan state, advanced on the RX stream thread
+    QList<unsigned long long> mScanCenters;
+    int mScanIndex = 0;
+    unsigned mScanSweeps = 0;
+    unsigned mScanBuffer = 0;           // buffers since the last retune
+    unsigned mSettleBuffers = 0;
+    unsigned mDwellBuffers = 0;
+    bool mScanFinished = false;
+
+    // AGC levels, accumulated on the RX stream thread
+    quint64 mAgcSamples = 0;
+    quint64 mAgcWindow = 0;             // samples per adjustment
+    std::array<quint64, 2> mAgcPowerSum {};
+    std::array<quint32, 2> mAgcPeakPower {};
+    std::atomic<quint64> mAgcSettleSamples { 0 };  // skipped after a gain change
+    // AGC state of the controller thread
+    std::array<int, 2> mAgcGain {};
+    QFile* mAgcLog = nullptr;
+
+    // Valid for the open device handle only
+    QHash<QPair<bladerf_channel, unsigned long long>, bladerf_quick_tune> mQuickTunes;
+    QList<QPair<bladerf_channel, unsigned long long>> mQuickTuneOrder;     // oldest first
 };
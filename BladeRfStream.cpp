@@ -1,16 +1,28 @@
 #include <QFile>
 #include <QDir>
 
+#include <chrono>
 #include <complex>
+#include <cstring>
 #include <cmath>
+#include <vector>
 
 #include "Types/RawData.hpp"
+#include "Tx/TxWaveformSource.hpp"
+#include "Tx/TxFileSource.hpp"
+#include "Tx/TxGainSource.hpp"
+#include "Tx/TxPlaylistSource.hpp"
+#include "Tx/TxResampleSource.hpp"
+#include "Tx/TxFeed.hpp"
 
 #include "BladeRfStream.hpp"
 
 #define ExecStatus(function)    { int status = function; if (status not_eq 0) { return status; } }
 
 #define BLADERF_DAC_MAX         1023.0
+#define MAX_UNDERRUN_EVENTS     1024
+#define SYNC_TIMEOUT_MS         1000
+#define TIMED_START_STEPS       10          // per second while waiting for the start
 
 BladeRfStream::BladeRfStream(bladerf* deviceHandle, bladerf_direction direction, ushort buffersCount)
     : deviceHandle(deviceHandle),
@@ -20,7 +32,8 @@ BladeRfStream::BladeRfStream(bladerf* deviceHandle, bladerf_direction direction,
       direction(direction),
       bufferIterator(0),
       buffersCount(buffersCount),
-      processFlag(false)
+      processFlag(false),
+      started(false)
 {
 
 }
@@ -37,16 +50,10 @@ BladeRfStream::~BladeRfStream()
 
     triggerDisarm();
     if (trigger) delete trigger;
+    if (txFeed) delete txFeed;
 
     if (stream) bladerf_deinit_stream(stream);
     if (mutex) delete mutex;
-    if (buffers)
-    {
-        for (ushort i = 0; i < buffersCount; ++i)
-            if (buffers[i])
-                delete[] buffers[i];
-        delete buffers;
-    }
 }
 
 int BladeRfStream::triggerArm(bladerf_trigger_role role)
@@ -80,11 +87,15 @@ int BladeRfStream::triggerFire()
     return bladerf_trigger_fire(deviceHandle, trigger);
 }
 
-int BladeRfStream::streamInit(const MissionConfig& config)
+int BladeRfStream::streamInit(const MissionConfig& config, unsigned channelsCount)
 {
     const auto transfersCount = (buffersCount > 1) ? buffersCount / 2 : 1;
 
     this->config = config;
+    this->channelsCount = channelsCount;
+
+    // The sync interface is configured on start, it needs the channel layout
+    if (timedStart()) return 0;
 
     return bladerf_init_stream(&stream,
                                deviceHandle,
@@ -92,14 +103,14 @@ int BladeRfStream::streamInit(const MissionConfig& config)
                                reinterpret_cast<void***>(&buffers),
                                buffersCount,
                                BLADERF_FORMAT_SC16_Q11,
-                               config.samplesCount,
+                               config.samplesCount * channelsCount,
                                transfersCount,
                                this);
 }
 
 int BladeRfStream::streamDeinit()
 {
-    bladerf_deinit_stream(stream);
+    if (stream) bladerf_deinit_stream(stream);
     stream = nullptr;
     buffers = nullptr;
     return 0;
@@ -109,19 +120,32 @@ int BladeRfStream::streamStart(bladerf_channel_layout layout)
 {
     streamStop();
 
-    if (direction == BLADERF_TX) generateTxBuffers();
+    if (direction == BLADERF_TX && !startTxFeed()) return BLADERF_ERR_IO;
+    if (timedStart()) ExecStatus(startTimedRx(layout));
+
+    started.store(false);
+    firstTimestamp.store(0);
+    streamEnded = false;
 
     streamThread = new std::thread([this, layout]()
     {
         processFlag.store(true);
-        const auto status = bladerf_stream(stream, layout);
+        const auto status = timedStart() ? receiveTimed() : bladerf_stream(stream, layout);
         processFlag.store(false);
 
+        {
+            const std::lock_guard<std::mutex> lock(*mutex);
+            streamEnded = true;
+        }
+        startedCondition.notify_all();
+
         if (status not_eq 0)
         {
             qWarning("stream error: %s", bladerf_strerror(status));
             emit errorOccured();
         }
+        else if (txFeed && txFeed->finished())
+            emit finished();
     });
 
     return 0;
@@ -138,33 +162,295 @@ int BladeRfStream::streamStop()
         streamThread = nullptr;
     }
 
+    if (syncChannels && stopTimedRx() not_eq 0)
+        qWarning("can't release the RX sync interface");
+
+    if (txFeed)
+    {
+        txFeed->stop();
+        txGain->fill(txStatistics);
+        txStatistics.lowWatermark = txFeed->lowWatermark();
+        delete txFeed;
+        txFeed = nullptr;
+        txGain = nullptr;
+    }
+
+    return 0;
+}
+
+int BladeRfStream::streamWaitStarted(unsigned timeoutMs)
+{
+    std::unique_lock<std::mutex> lock(*mutex);
+    startedCondition.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                              [this]() { return started.load() || streamEnded; });
+
+    if (started.load()) return 0;
+    return streamEnded ? BLADERF_ERR_IO : BLADERF_ERR_TIMEOUT;
+}
+
+bool BladeRfStream::timedStart() const
+{
+    return direction == BLADERF_RX && (config.rxStartTimestamp || config.rxStartOffset);
+}
+
+int BladeRfStream::startTimedRx(bladerf_channel_layout layout)
+{
+    const int channels = (layout == BLADERF_RX_X2) ? 2 : 1;
+
+    // The sync interface has to be configured before the module is enabled
+    for (int i = 0; i < channels; ++i)
+        ExecStatus(bladerf_enable_module(deviceHandle, BLADERF_CHANNEL_RX(i), false));
+
+    ExecStatus(bladerf_sync_config(deviceHandle,
+                                   layout,
+                                   BLADERF_FORMAT_SC16_Q11_META,
+                                   buffersCount,
+                                   config.samplesCount * channelsCount,
+                                   (buffersCount > 1) ? buffersCount / 2 : 1,
+                                   SYNC_TIMEOUT_MS));
+
+    syncChannels = channels;
+    for (int i = 0; i < channels; ++i)
+        ExecStatus(bladerf_enable_module(deviceHandle, BLADERF_CHANNEL_RX(i), true));
+
+    return 0;
+}
+
+int BladeRfStream::stopTimedRx()
+{
+    // Disabling the module releases the sync interface and its META format,
+    // the next session gets the channels back on the async stream
+    int status = 0;
+    for (int i = 0; i < syncChannels; ++i)
+    {
+        const auto channelStatus = bladerf_enable_module(deviceHandle, BLADERF_CHANNEL_RX(i), false);
+        if (channelStatus not_eq 0) status = channelStatus;
+    }
+
+    syncChannels = 0;
+    return status;
+}
+
+int BladeRfStream::receiveTimed()
+{
+    const unsigned count = config.samplesCount * channelsCount;
+    const bladerf_timestamp step = std::max<bladerf_timestamp>(config.sampleRate / TIMED_START_STEPS, 1);
+    std::vector<short> buffer(2 * size_t(count));
+    bladerf_metadata meta = {};
+    int status = 0;
+
+    // One sample per channel tells where the stream is. A start offset holds
+    // the stream on the RX master trigger, so this is the first sample past the edge
+    do
+    {
+        meta.flags = BLADERF_META_FLAG_RX_NOW;
+        status = bladerf_sync_rx(deviceHandle, buffer.data(), channelsCount, &meta, SYNC_TIMEOUT_MS);
+    }
+    while (status == BLADERF_ERR_TIMEOUT && processFlag.load());
+    if (status not_eq 0) return processFlag.load() ? status : 0;
+
+    const auto start = config.rxStartTimestamp ? config.rxStartTimestamp : meta.timestamp + config.rxStartOffset;
+    if (start <= meta.timestamp)
+    {
+        qWarning("RX start timestamp %llu has passed, the stream is at %llu",
+                 (unsigned long long)start, (unsigned long long)meta.timestamp);
+        return BLADERF_ERR_TIME_PAST;
+    }
+
+    {
+        const std::lock_guard<std::mutex> lock(*mutex);
+        started.store(true);
+    }
+    startedCondition.notify_all();
+
+    // libbladeRF drops everything before a requested timestamp without handing
+    // it out. The wait is split into steps so a stop is not held up by it;
+    // every step copies a single sample per channel.
+    while (meta.timestamp + step < start)
+    {
+        if (!processFlag.load()) return 0;
+
+        meta.flags = 0;
+        meta.timestamp += step;
+        ExecStatus(bladerf_sync_rx(deviceHandle, buffer.data(), channelsCount, &meta, SYNC_TIMEOUT_MS));
+    }
+
+    qInfo("RX recording starts at timestamp %llu", (unsigned long long)start);
+    firstTimestamp.store(start);
+
+    unsigned filled = 0;
+
+    // Copies samples (zeros for nullptr) into the buffer, emitting it when full
+    const auto append = [&](const short* samples, quint64 samplesCount)
+    {
+        while (samplesCount)
+        {
+            const auto chunk = unsigned(std::min<quint64>(samplesCount, count - filled));
+            const auto target = buffer.data() + 2 * size_t(filled);
+
+            if (samples)
+            {
+                std::memcpy(target, samples, 2 * sizeof(short) * chunk);
+                samples += 2 * size_t(chunk);
+            }
+            else
+                std::memset(target, 0, 2 * sizeof(short) * chunk);
+
+            filled += chunk;
+            samplesCount -= chunk;
+
+            if (filled == count)
+            {
+                emit data(buffer.data(), count);
+                filled = 0;
+            }
+        }
+    };
+
+    bladerf_timestamp expected = start;
+    meta.flags = 0;
+    meta.timestamp = start;
+
+    while (processFlag.load())
+    {
+        const auto target = buffer.data() + 2 * size_t(filled);
+        ExecStatus(bladerf_sync_rx(deviceHandle, target, count - filled, &meta, SYNC_TIMEOUT_MS));
+        meta.flags = BLADERF_META_FLAG_RX_NOW;
+
+        // An overrun ends a read early, the next one resumes past the gap
+        const unsigned received = (meta.status & BLADERF_META_STATUS_OVERRUN) ? meta.actual_count : count - filled;
+
+        if (meta.timestamp > expected)
+        {
+            // The gap is filled with zeros, so buffer positions stay device sample positions
+            qWarning("RX overrun: %llu samples lost at timestamp %llu",
+                     (unsigned long long)(meta.timestamp - expected), (unsigned long long)expected);
+
+            const std::vector<short> resumed(target, target + 2 * size_t(received));
+            append(nullptr, quint64(meta.timestamp - expected) * channelsCount);
+            append(resumed.data(), received);
+        }
+        else
+        {
+            filled += received;
+            if (filled == count)
+            {
+                emit data(buffer.data(), count);
+                filled = 0;
+            }
+        }
+
+        expected = meta.timestamp + received / channelsCount;
+    }
+
     return 0;
 }
 
-void BladeRfStream::generateTxBuffers()
+bladerf_timestamp BladeRfStream::startTimestamp() const
 {
-    // TODO: read from file
-    QFile txData(QDir::current().absoluteFilePath(config.fileName));
+    return firstTimestamp.load();
+}
 
-    if (!txData.open(QIODevice::ReadOnly))
-        qFatal("Can't open tx data file: %s", qPrintable(txData.errorString()));
+bool BladeRfStream::setTxGain(double gainDb)
+{
+    if (!txGain) return false;
 
-    const auto data = txData.read(config.samplesCount * SAMPLE_SIZE_BYTES);
-    const auto dataPtr = (short*)data.data();
+    txGain->setGainDb(gainDb);
+    config.txGainDb = gainDb;
+    return true;
+}
 
-    buffers = new short*[buffersCount];
+const SessionStatistics& BladeRfStream::statistics() const
+{
+    return txStatistics;
+}
 
-    for (quint32 buffer = 0; buffer < buffersCount; ++buffer)
+bool BladeRfStream::startTxFeed()
+{
+    const auto capacity = quint32(std::min<quint64>(config.txReadAhead * config.samplesCount, UINT32_MAX / 2));
+
+    const auto preRoll = quint32(std::min<quint64>(config.txPreRoll * config.samplesCount, capacity));
+
+    txStatistics = SessionStatistics();
+    txStatistics.sampleRate = config.sampleRate;
+    txStatistics.capacity = capacity;
+    txStatistics.underrunEvents.reserve(MAX_UNDERRUN_EVENTS);
+
+    // Level is reported about once a second
+    txGain = new TxGainSource(createTxSource(), config.txGainDb, config.sampleRate);
+    txFeed = new TxFeed(txGain, capacity, TxFeed::endOfSourceFromString(config.txEndOfFile));
+    if (!txFeed->start(preRoll))
+    {
+        qWarning("Can't open tx source: %s", qPrintable(txFeed->errorString()));
+        delete txFeed;
+        txFeed = nullptr;
+        txGain = nullptr;
+        return false;
+    }
+
+    txStatistics.preRoll = txFeed->available();
+
+    // Stream buffers are filled on demand by the callback, the first ones as
+    // libbladeRF collects its initial transfers (no samples are passed then)
+    return true;
+}
+
+TxSource* BladeRfStream::createTxSource() const
+{
+    TxSource* source = nullptr;
+
+    if (config.waveform.enabled())
+        return new TxWaveformSource(config.waveform, config.sampleRate);
+
+    if (!config.playlist.isEmpty())
+        source = new TxPlaylistSource(config.playlist,
+                                      TxFileSource::formatFromString(config.txFormat),
+                                      config.txNormalize,
+                                      float(config.txScale),
+                                      TxFeed::endOfSourceFromString(config.txEndOfFile) == EndOfSource::Loop);
+    else
+        source = new TxFileSource(QDir::current().absoluteFilePath(config.fileName),
+                                  TxFileSource::formatFromString(config.txFormat),
+                                  config.txNormalize,
+                                  float(config.txScale));
+
+    if (config.txSourceRate && config.txSourceRate != config.sampleRate)
+        source = new TxResampleSource(source, config.txSourceRate, config.sampleRate,
+                                      TxFeed::endOfSourceFromString(config.txEndOfFile) != EndOfSource::Loop);
+
+    return source;
+}
+
+bool BladeRfStream::fillTxBuffer(short* buffer, size_t samplesCount)
+{
+    if (txFeed->finished()) return false;
+
+    const auto count = txFeed->pop(buffer, quint32(samplesCount));
+    txGain->apply(buffer, count);
+
+    if (count < samplesCount)
     {
-        const auto samplesCount = config.samplesCount;
+        const auto missing = quint32(samplesCount - count);
+        std::memset(buffer + 2 * count, 0, missing * SAMPLE_SIZE_BYTES);
 
-        buffers[buffer] = new short[samplesCount];
-        for (quint64 i = 0; i < samplesCount; i++)
+        // Zeros at the tail of a stopping source are expected, anything else is a gap
+        if (!txFeed->sourceEnded())
         {
-            buffers[buffer][i] = dataPtr[i];
-            buffers[buffer][i + 1] = dataPtr[i + 1];
+            ++txStatistics.underruns;
+            txStatistics.underrunSamples += missing;
+
+            if (txStatistics.underrunEvents.size() < MAX_UNDERRUN_EVENTS)
+            {
+                const auto now = std::chrono::system_clock::now().time_since_epoch();
+                txStatistics.underrunEvents.append({ txStatistics.samplesSent + count,
+                                                     std::chrono::duration_cast<std::chrono::milliseconds>(now).count(),
+                                                     missing });
+            }
         }
     }
+
+    txStatistics.samplesSent += samplesCount;
+    return true;
 }
 
 void* BladeRfStream::callback(bladerf*, struct bladerf_stream*, bladerf_metadata*,
@@ -174,10 +460,29 @@ void* BladeRfStream::callback(bladerf*, struct bladerf_stream*, bladerf_metadata
     if (!instance) return BLADERF_STREAM_SHUTDOWN;
 
     if (!instance->processFlag.load()) return BLADERF_STREAM_SHUTDOWN;
-    else if (instance->direction == BLADERF_RX)
+
+    // RX: the first samples arrived; TX: the first buffers are being submitted
+    if (!instance->started.load(std::memory_order_relaxed))
+    {
+        {
+            const std::lock_guard<std::mutex> lock(*instance->mutex);
+            instance->started.store(true);
+        }
+        instance->startedCondition.notify_all();
+    }
+
+    if (instance->direction == BLADERF_RX && data)
         emit instance->data(reinterpret_cast<short*>(data), samplesCount);
 
     if (++instance->bufferIterator >= instance->buffersCount)
         instance->bufferIterator.store(0);
-    return instance->buffers[instance->bufferIterator.load()];
+
+    // A TX buffer is always filled whole: the initial transfers are collected
+    // with a samples count of 0
+    const auto buffer = instance->buffers[instance->bufferIterator.load()];
+    if (instance->direction == BLADERF_TX
+    &&  !instance->fillTxBuffer(buffer, size_t(instance->config.samplesCount) * instance->channelsCount))
+        return BLADERF_STREAM_SHUTDOWN;
+
+    return buffer;
 }
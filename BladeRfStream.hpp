@@ -3,19 +3,27 @@
 #include <QObject>
 
 #include <atomic>
+#include <condition_variable>
 #include <thread>
 #include <mutex>
 
 #include <libbladeRF.h>
 
 #include "Types/MissionConfig.hpp"
+#include "Types/SessionStatistics.hpp"
+
+class TxFeed;
+class TxGainSource;
+class TxSource;
 
 struct BladeRfStream : public QObject
 {
     Q_OBJECT
 signals:
     void errorOccured();
-    void data(short* buffer, short samplesCount);
+    void data(short* buffer, unsigned samplesCount);
+    /// TX source is over (end of file with the stop policy)
+    void finished();
 
 public:
     BladeRfStream() = default;
@@ -27,13 +35,31 @@ public:
     int triggerRearm();
     int triggerFire();
 
-    int streamInit(const MissionConfig& config);
+    int streamInit(const MissionConfig& config, unsigned channelsCount = 1);
     int streamDeinit();
     int streamStart(bladerf_channel_layout layout);
     int streamStop();
+    /// Blocks until the first buffer is exchanged with the device, BLADERF_ERR_TIMEOUT if it is not
+    int streamWaitStarted(unsigned timeoutMs);
+
+    /// Device timestamp of RX sample 0 of a timed start, 0 - not known
+    bladerf_timestamp startTimestamp() const;
+
+    /// Digital gain of a running TX stream, false if there is none
+    bool setTxGain(double gainDb);
+
+    /// TX counters of the last session, complete once the stream is stopped
+    const SessionStatistics& statistics() const;
 
 private:
-    void generateTxBuffers();
+    bool startTxFeed();
+    bool timedStart() const;
+    int startTimedRx(bladerf_channel_layout layout);
+    int stopTimedRx();
+    /// Sync RX loop of a timed start, in place of bladerf_stream
+    int receiveTimed();
+    TxSource* createTxSource() const;
+    bool fillTxBuffer(short* buffer, size_t samplesCount);
 
 private:
     static void* callback(bladerf* device, struct bladerf_stream* stream, bladerf_metadata* meta,
@@ -45,12 +71,21 @@ private:
     struct bladerf_stream* stream = nullptr;
     mutable std::mutex* mutex = nullptr;
     bladerf_trigger* trigger = nullptr;
-    short** buffers = nullptr;
+    short** buffers = nullptr;          // owned by libbladeRF
+    TxFeed* txFeed = nullptr;
+    TxGainSource* txGain = nullptr;     // owned by txFeed
+    SessionStatistics txStatistics;
     bladerf_trigger_role triggerRole;
     bladerf_direction direction;
+    unsigned channelsCount = 1;
+    int syncChannels = 0;               // RX channels left on the sync interface
     std::atomic_uint16_t bufferIterator;
     std::atomic_uint16_t buffersCount;
     std::atomic_bool processFlag;
+    std::atomic_bool started;
+    std::atomic<bladerf_timestamp> firstTimestamp { 0 };
+    std::condition_variable startedCondition;   // guarded by mutex
+    bool streamEnded = false;                   // guarded by mutex
 
     MissionConfig config;
 
@@ -0,0 +1,110 @@
+#include <QLocalServer>
+#include <QLocalSocket>
+
+#include "ControlServer.hpp"
+
+#define MAX_COMMAND_LENGTH      256
+#define PROBE_TIMEOUT_MS        100
+
+ControlServer::ControlServer(QObject* parent)
+    : QObject(parent),
+      mServer(new QLocalServer(this))
+{
+    connect(mServer, &QLocalServer::newConnection,
+            this,    &ControlServer::onNewConnection);
+}
+
+ControlServer::~ControlServer()
+{
+    mServer->close();
+}
+
+bool ControlServer::listen(const QString& name)
+{
+    // A socket file left by a crashed instance would block the name, one that
+    // still answers belongs to a running instance and is left alone
+    QLocalSocket probe;
+    probe.connectToServer(name);
+    if (probe.waitForConnected(PROBE_TIMEOUT_MS))
+    {
+        qWarning("Control socket %s is in use by another instance", qPrintable(name));
+        return false;
+    }
+    QLocalServer::removeServer(name);
+
+    // Only the owner of the process may drive the radio
+    mServer->setSocketOptions(QLocalServer::UserAccessOption);
+    if (!mServer->listen(name))
+    {
+        qWarning("Can't open control socket %s: %s", qPrintable(name), qPrintable(mServer->errorString()));
+        return false;
+    }
+
+    qInfo("Control socket %s", qPrintable(mServer->fullServerName()));
+    return true;
+}
+
+void ControlServer::reply(quint64 client, bool ok, const QByteArray& message)
+{
+    const auto socket = mClients.value(client);
+    if (!socket) return;
+
+    QByteArray line(ok ? "ok" : "error");
+    if (!message.isEmpty())
+    {
+        line += ' ';
+        line += message;
+    }
+    line += '\n';
+
+    socket->write(line);
+    socket->flush();
+}
+
+void ControlServer::onNewConnection()
+{
+    while (mServer->hasPendingConnections())
+    {
+        const auto socket = mServer->nextPendingConnection();
+        const auto client = mNextClient++;
+
+        mClients.insert(client, socket);
+
+        connect(socket, &QLocalSocket::readyRead,
+                this,   [this, client]() { onReadyRead(client); });
+        connect(socket, &QLocalSocket::disconnected,
+                this,   [this, client, socket]() {
+                    mClients.remove(client);
+                    socket->deleteLater();
+                });
+    }
+}
+
+void ControlServer::onReadyRead(quint64 client)
+{
+    const auto socket = mClients.value(client);
+    if (!socket) return;
+
+    while (socket->canReadLine())
+    {
+        // Whole lines only: an overlong one is dropped, not split into commands
+        const auto raw = socket->readLine();
+        if (raw.size() > MAX_COMMAND_LENGTH)
+        {
+            reply(client, false, "command too long");
+            continue;
+        }
+
+        const auto line = QString::fromUtf8(raw).trimmed();
+        const auto command = line.split(' ', Qt::SkipEmptyParts);
+
+        if (!command.isEmpty()) emit commandReceived(client, command);
+    }
+
+    // An unterminated line past the limit is not waited for
+    if (socket->bytesAvailable() > MAX_COMMAND_LENGTH)
+    {
+        reply(client, false, "command too long");
+        socket->disconnectFromServer();
+    }
+}
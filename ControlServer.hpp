@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QStringList>
+
+class QLocalServer;
+class QLocalSocket;
+
+// Unix-domain control socket, one text command per line:
+//
+//   retune <hz>    gain <value>    start    stop    rotate    stats
+//
+// Every command gets one reply line, "ok[ <json>]" or "error <message>".
+// Replies may arrive later than the command, clients are tracked by id so
+// a client that went away in between is simply skipped.
+class ControlServer : public QObject
+{
+    Q_OBJECT
+signals:
+    void commandReceived(quint64 client, const QStringList& command);
+
+public:
+    explicit ControlServer(QObject* parent = nullptr);
+    ~ControlServer();
+
+    bool listen(const QString& name);
+    void reply(quint64 client, bool ok, const QByteArray& message = QByteArray());
+
+private slots:
+    void onNewConnection();
+
+private:
+    void onReadyRead(quint64 client);
+
+private:
+    QLocalServer* mServer = nullptr;
+    QHash<quint64, QLocalSocket*> mClients;
+    quint64 mNextClient = 1;
+};
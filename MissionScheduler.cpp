@@ -0,0 +1,203 @@
+#include <QJsonArray>
+#include <QTimer>
+
+#include "MissionScheduler.hpp"
+
+DefineJsonField(missions)
+DefineJsonField(start_times)
+
+MissionScheduler::MissionScheduler(const QJsonObject& settings, QObject* parent)
+    : QObject(parent),
+      mStartTimer(new QTimer(this)),
+      mDurationTimer(new QTimer(this))
+{
+    const auto overrides = settings[i_missions].toArray();
+
+    for (int i = 0; i < std::max(overrides.size(), 1); ++i)
+    {
+        auto json = settings;
+        const auto mission = overrides.at(i).toObject();
+
+        for (const auto& key : mission.keys())
+            json.insert(key, mission[key]);
+
+        MissionConfig config;
+        config.fromJson(json);
+        mMissions.append(config);
+        mMissionSettings.append(json);
+    }
+
+    for (const auto& value : settings[i_start_times].toArray())
+        mStartTimes.append(QDateTime::fromString(value.toString(), Qt::ISODate));
+
+    mPasses = mMissions.first().tryCount;
+    mRunsPlanned = quint64(mPasses) * mMissions.size();
+    if (!mStartTimes.isEmpty() && (mRunsPlanned == 0 || mRunsPlanned > quint64(mStartTimes.size())))
+        mRunsPlanned = mStartTimes.size();
+
+    // Classic single session that runs until the process is stopped
+    if (mPasses == UNLIMITED && mMissions.size() == 1 && mStartTimes.isEmpty() && mMissions.first().duration <= 0)
+        mRunsPlanned = 1;
+
+    mStartTimer->setSingleShot(true);
+    mStartTimer->setTimerType(Qt::PreciseTimer);
+    mDurationTimer->setSingleShot(true);
+    connect(mStartTimer,    &QTimer::timeout, this, &MissionScheduler::startRun);
+    connect(mDurationTimer, &QTimer::timeout, this, &MissionScheduler::stopRequested);
+}
+
+bool MissionScheduler::valid() const
+{
+    for (const auto& mission : mMissions)
+        if (!mission.valid()) return false;
+
+    for (const auto& time : mStartTimes)
+        if (!time.isValid()) return false;
+
+    return true;
+}
+
+const MissionConfig& MissionScheduler::first() const
+{
+    return mMissions.first();
+}
+
+QJsonObject MissionScheduler::currentSettings() const
+{
+    return mMissionSettings[mission()];
+}
+
+bool MissionScheduler::reload(const QJsonObject& settings)
+{
+    const MissionScheduler candidate(settings);
+    if (!candidate.valid()) return false;
+
+    // The run counters stay; a new duration applies from the next run
+    mMissions = candidate.mMissions;
+    mMissionSettings = candidate.mMissionSettings;
+    mStartTimes = candidate.mStartTimes;
+    mPasses = candidate.mPasses;
+    mRunsPlanned = candidate.mRunsPlanned ? candidate.mRunsPlanned + mRepeats : 0;
+    return true;
+}
+
+void MissionScheduler::start()
+{
+    if (mRunsPlanned != 1)
+        qInfo("Mission schedule: %d missions, %s runs%s",
+              mMissions.size(),
+              mRunsPlanned ? qPrintable(QString::number(mRunsPlanned)) : "endless",
+              mStartTimes.isEmpty() ? "" : " at wall-clock times");
+
+    scheduleNext();
+}
+
+void MissionScheduler::onSessionStarted()
+{
+    if (!mRunning) return;
+
+    const auto& config = mMissions[mission()];
+    if (config.duration > 0) mDurationTimer->start(qRound64(config.duration * 1000));
+}
+
+void MissionScheduler::onSessionStopped()
+{
+    // Stopping is reported again by error paths and on exit
+    if (!mRunning) return;
+
+    mRunning = false;
+    mDurationTimer->stop();
+
+    if (mRepeat)
+    {
+        // One more run of the same mission, its start time has already come
+        ++mRepeats;
+        if (mRunsPlanned) ++mRunsPlanned;
+        mStartTimer->start(0);
+    }
+    else if (!mHeld) scheduleNext();
+}
+
+void MissionScheduler::hold()
+{
+    mHeld = true;
+    mRepeat = false;
+    mStartTimer->stop();
+    if (mRunning) emit stopRequested();
+}
+
+void MissionScheduler::restart()
+{
+    if (!mRunning) return;
+
+    mRepeat = true;
+    emit stopRequested();
+}
+
+bool MissionScheduler::resume()
+{
+    if (mRunning || mStartTimer->isActive()) return false;
+
+    mHeld = false;
+    if (mRunsPlanned && mRun >= mRunsPlanned) mRunsPlanned = mRun + 1;
+
+    mStartTimer->start(0);
+    return true;
+}
+
+void MissionScheduler::startRun()
+{
+    // Long waits are re-armed until the start time is reached
+    const auto scheduled = int(mRun - mRepeats);
+    if (!mRepeat && scheduled < mStartTimes.size() && QDateTime::currentDateTime() < mStartTimes[scheduled])
+    {
+        scheduleNext();
+        return;
+    }
+
+    if (!mRepeat) mMission = scheduled % mMissions.size();
+    mRepeat = false;
+
+    auto config = mMissions[mission()];
+
+    if (mRunsPlanned != 1)
+    {
+        const auto run = QString("run_%1").arg(mRun + 1, 4, 10, QChar('0'));
+        config.outputDirectory = config.outputDirectory.isEmpty() ? run : config.outputDirectory + '/' + run;
+        qInfo("Run %llu: %llu Hz, output %s", mRun + 1, config.frequency, qPrintable(config.outputDirectory));
+    }
+
+    ++mRun;
+    mRunning = true;
+    emit sessionRequested(config);
+}
+
+void MissionScheduler::scheduleNext()
+{
+    if (mRunsPlanned && mRun >= mRunsPlanned)
+    {
+        emit finished();
+        return;
+    }
+
+    if (mStartTimes.isEmpty())
+    {
+        // The device stays open, the next run starts right away
+        mStartTimer->start(0);
+        return;
+    }
+
+    const auto scheduled = int(mRun - mRepeats);
+    const auto delay = QDateTime::currentDateTime().msecsTo(mStartTimes[scheduled]);
+    if (delay < 0)
+        qWarning("Run %llu start time %s has passed, starting now",
+                 mRun + 1, qPrintable(mStartTimes[scheduled].toString(Qt::ISODate)));
+
+    mStartTimer->start(int(std::min<qint64>(std::max<qint64>(delay, 0), INT_MAX)));
+}
+
+int MissionScheduler::mission() const
+{
+    // A reload may have shortened the mission list
+    return mMission < mMissions.size() ? mMission : 0;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QObject>
+#include <QDateTime>
+#include <QList>
+
+#include "Types/MissionConfig.hpp"
+
+class QTimer;
+
+// Runs a sequence of sessions from one settings file on the open device.
+//
+// "missions" - objects overriding keys of the base settings, run in turn
+//              (the base settings alone if empty)
+// "tryes"    - passes over the missions, 0 - endless
+// "start_times" - ISO local times the runs start at, one per run
+// "duration" of a mission ends its run, 0 - when the session stops by itself
+//
+// With more than one run every run writes into its own run_NNNN directory.
+class MissionScheduler : public QObject
+{
+    Q_OBJECT
+signals:
+    void sessionRequested(const MissionConfig& config);
+    void stopRequested();
+    void finished();
+
+public:
+    explicit MissionScheduler(const QJsonObject& settings, QObject* parent = nullptr);
+
+    bool valid() const;
+    /// First mission, describes what the device is opened for
+    const MissionConfig& first() const;
+    /// Settings of the mission running now, overrides applied
+    QJsonObject currentSettings() const;
+    /// Replaces the missions for the current and the next runs, false if invalid
+    bool reload(const QJsonObject& settings);
+
+public slots:
+    void start();
+    void onSessionStarted();
+    void onSessionStopped();
+    /// Stops the current run and keeps the schedule paused
+    void hold();
+    /// Starts the next run right away, after the last one too
+    bool resume();
+    /// Runs the current mission again, with the reloaded settings
+    void restart();
+
+private slots:
+    void startRun();
+
+private:
+    void scheduleNext();
+    int mission() const;
+
+private:
+    QList<MissionConfig> mMissions;
+    QList<QJsonObject> mMissionSettings;
+    QList<QDateTime> mStartTimes;
+    unsigned mPasses = UNLIMITED;
+    quint64 mRunsPlanned = 0;           // 0 - endless
+
+    quint64 mRun = 0;                   // runs started
+    bool mRunning = false;
+    bool mHeld = false;
+    bool mRepeat = false;               // the next run repeats the current mission
+    quint64 mRepeats = 0;               // runs that did not advance the schedule
+    int mMission = 0;                   // mission of the current run
+
+    QTimer* mStartTimer = nullptr;
+    QTimer* mDurationTimer = nullptr;
+};
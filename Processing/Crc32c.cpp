@@ -0,0 +1,103 @@
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <nmmintrin.h>
+    #define CRC32C_X86
+#endif
+
+#include "Crc32c.hpp"
+
+#define CRC32C_POLYNOMIAL       0x82F63B78
+
+namespace
+{
+
+struct Tables
+{
+    Tables()
+    {
+        for (quint32 i = 0; i < 256; ++i)
+        {
+            quint32 crc = i;
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc >> 1) ^ (CRC32C_POLYNOMIAL & -(crc & 1));
+            slice[0][i] = crc;
+        }
+
+        for (quint32 i = 0; i < 256; ++i)
+            for (int k = 1; k < 8; ++k)
+                slice[k][i] = (slice[k - 1][i] >> 8) ^ slice[0][slice[k - 1][i] & 0xFF];
+    }
+
+    quint32 slice[8][256];
+};
+
+// Slicing-by-8 fallback
+quint32 software(quint32 crc, const quint8* data, size_t size)
+{
+    static const Tables tables;
+    const auto& t = tables.slice;
+
+    for (; size >= 8; size -= 8, data += 8)
+    {
+        quint32 low;
+        quint32 high;
+        std::memcpy(&low, data, sizeof(low));
+        std::memcpy(&high, data + 4, sizeof(high));
+        low ^= crc;
+
+        crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24]
+            ^ t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+    }
+
+    while (size--)
+        crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF];
+
+    return crc;
+}
+
+#ifdef CRC32C_X86
+__attribute__((target("sse4.2")))
+quint32 hardware(quint32 crc, const quint8* data, size_t size)
+{
+    for (; size && (reinterpret_cast<quintptr>(data) & 7); --size)
+        crc = _mm_crc32_u8(crc, *data++);
+
+    quint64 crc64 = crc;
+    for (; size >= 8; size -= 8, data += 8)
+    {
+        quint64 value;
+        std::memcpy(&value, data, sizeof(value));
+        crc64 = _mm_crc32_u64(crc64, value);
+    }
+    crc = quint32(crc64);
+
+    while (size--)
+        crc = _mm_crc32_u8(crc, *data++);
+
+    return crc;
+}
+#endif
+
+} // namespace
+
+quint32 Crc32c::update(quint32 crc, const void* data, size_t size)
+{
+    const auto bytes = static_cast<const quint8*>(data);
+
+#ifdef CRC32C_X86
+    if (hardwareAccelerated()) return ~hardware(~crc, bytes, size);
+#endif
+
+    return ~software(~crc, bytes, size);
+}
+
+bool Crc32c::hardwareAccelerated()
+{
+#ifdef CRC32C_X86
+    static const bool supported = __builtin_cpu_supports("sse4.2");
+    return supported;
+#else
+    return false;
+#endif
+}
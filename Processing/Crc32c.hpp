@@ -0,0 +1,12 @@
+#pragma once
+
+#include <QtGlobal>
+
+// CRC-32C (Castagnoli). Uses the SSE4.2 crc32 instruction when the CPU has it.
+class Crc32c
+{
+public:
+    /// Continues crc (0 for a new checksum) over size bytes of data
+    static quint32 update(quint32 crc, const void* data, size_t size);
+    static bool hardwareAccelerated();
+};
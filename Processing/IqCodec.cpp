@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <cstring>
+
+#include "Types/RawData.hpp"
+
+#include "IqCodec.hpp"
+
+#define DELTA_FLAG              0x80
+#define WIDTH_MASK              0x1F
+#define MAX_WIDTH               17      // delta of two 16-bit values
+
+namespace
+{
+
+inline quint32 zigzag(qint32 value)
+{
+    return (quint32(value) << 1) ^ quint32(value >> 31);
+}
+
+inline qint32 unzigzag(quint32 value)
+{
+    return qint32(value >> 1) ^ -qint32(value & 1);
+}
+
+inline quint8 bitWidth(quint32 value)
+{
+    return value ? quint8(32 - __builtin_clz(value)) : 0;
+}
+
+struct BitWriter
+{
+    quint8* out;
+    quint64 accumulator = 0;
+    int bits = 0;
+
+    inline void put(quint32 value, int width)
+    {
+        accumulator |= quint64(value) << bits;
+        bits += width;
+        if (bits >= 32)
+        {
+            const quint32 word = quint32(accumulator);
+            std::memcpy(out, &word, sizeof(word));
+            out += sizeof(word);
+            accumulator >>= 32;
+            bits -= 32;
+        }
+    }
+
+    inline void align()
+    {
+        for (; bits > 0; bits -= 8, accumulator >>= 8)
+            *out++ = quint8(accumulator);
+        bits = 0;
+        accumulator = 0;
+    }
+};
+
+// Computes residuals of one component (stride 2) of a group for both predictors
+// and keeps the cheaper one. Returns the group descriptor.
+quint8 predict(const qint16* values, quint32 count, qint32 previous, quint32* residuals)
+{
+    quint32 raw[IqCodec::GROUP_SAMPLES];
+    quint32 delta[IqCodec::GROUP_SAMPLES];
+    quint32 rawMask = 0;
+    quint32 deltaMask = 0;
+
+    raw[0] = zigzag(values[0]);
+    delta[0] = zigzag(values[0] - previous);
+    for (quint32 i = 1; i < count; ++i)
+    {
+        raw[i] = zigzag(values[2 * i]);
+        delta[i] = zigzag(values[2 * i] - values[2 * (i - 1)]);
+    }
+    for (quint32 i = 0; i < count; ++i)
+    {
+        rawMask |= raw[i];
+        deltaMask |= delta[i];
+    }
+
+    const auto rawWidth = bitWidth(rawMask);
+    const auto deltaWidth = bitWidth(deltaMask);
+
+    if (deltaWidth < rawWidth)
+    {
+        std::memcpy(residuals, delta, count * sizeof(quint32));
+        return DELTA_FLAG | deltaWidth;
+    }
+
+    std::memcpy(residuals, raw, count * sizeof(quint32));
+    return rawWidth;
+}
+
+void pack(BitWriter& writer, const quint32* residuals, quint32 count, int width)
+{
+    if (width == 0) return;
+    for (quint32 i = 0; i < count; ++i)
+        writer.put(residuals[i], width);
+    writer.align();
+}
+
+bool unpack(const quint8*& in, const quint8* end, quint8 descriptor,
+            quint32 count, qint32& previous, qint16* values)
+{
+    const int width = descriptor & WIDTH_MASK;
+    if (width > MAX_WIDTH) return false;
+
+    const quint64 bytes = (quint64(count) * width + 7) / 8;
+    if (in + bytes > end) return false;
+
+    const quint32 mask = (1u << width) - 1;
+    quint64 accumulator = 0;
+    int bits = 0;
+
+    for (quint32 i = 0; i < count; ++i)
+    {
+        while (bits < width)
+        {
+            accumulator |= quint64(*in++) << bits;
+            bits += 8;
+        }
+
+        const qint32 residual = unzigzag(quint32(accumulator) & mask);
+        accumulator >>= width;
+        bits -= width;
+
+        previous = (descriptor & DELTA_FLAG) ? previous + residual : residual;
+        values[2 * i] = qint16(previous);
+    }
+
+    return true;
+}
+
+} // namespace
+
+QByteArray IqCodec::encode(const qint16* values, quint32 count)
+{
+    QByteArray block(int(maxEncodedSize(count)), Qt::Uninitialized);
+    quint32 residualsI[GROUP_SAMPLES];
+    quint32 residualsQ[GROUP_SAMPLES];
+    qint32 previousI = 0;
+    qint32 previousQ = 0;
+
+    const quint32 samples = count / 2;
+    BitWriter writer { reinterpret_cast<quint8*>(block.data()) + HEADER_SIZE };
+
+    for (quint32 group = 0; group < samples; group += GROUP_SAMPLES)
+    {
+        const quint32 n = std::min(GROUP_SAMPLES, samples - group);
+        const qint16* groupValues = values + 2 * group;
+
+        const quint8 descriptorI = predict(groupValues, n, previousI, residualsI);
+        const quint8 descriptorQ = predict(groupValues + 1, n, previousQ, residualsQ);
+        previousI = groupValues[2 * (n - 1)];
+        previousQ = groupValues[2 * (n - 1) + 1];
+
+        *writer.out++ = descriptorI;
+        *writer.out++ = descriptorQ;
+        pack(writer, residualsI, n, descriptorI & WIDTH_MASK);
+        pack(writer, residualsQ, n, descriptorQ & WIDTH_MASK);
+    }
+
+    const quint32 size = quint32(writer.out - reinterpret_cast<quint8*>(block.data()));
+    const quint32 header[] = { BLOCK_MAGIC, samples * 2, size - HEADER_SIZE };
+    std::memcpy(block.data(), header, HEADER_SIZE);
+
+    block.resize(size);
+    return block;
+}
+
+quint64 IqCodec::maxEncodedSize(quint32 count)
+{
+    const quint64 groups = (quint64(count) / 2 + GROUP_SAMPLES - 1) / GROUP_SAMPLES;
+    const quint64 groupSize = 2 + 2 * ((GROUP_SAMPLES * MAX_WIDTH + 7) / 8);
+    return HEADER_SIZE + groups * groupSize + sizeof(quint32);
+}
+
+quint32 IqCodec::blockSize(const char* data, qint64 available)
+{
+    quint32 header[3];
+    if (available < qint64(HEADER_SIZE)) return 0;
+
+    std::memcpy(header, data, HEADER_SIZE);
+    if (header[0] != BLOCK_MAGIC) return 0;
+    if (header[2] > maxEncodedSize(header[1]) || header[2] > UINT32_MAX - HEADER_SIZE) return 0;
+
+    return HEADER_SIZE + header[2];
+}
+
+bool IqCodec::decode(const char* block, quint32 size, QByteArray& out)
+{
+    quint32 header[3];
+    if (size < HEADER_SIZE) return false;
+
+    std::memcpy(header, block, HEADER_SIZE);
+    if (header[0] != BLOCK_MAGIC || HEADER_SIZE + header[2] != size) return false;
+
+    // Every group takes at least its two descriptors, a count the payload
+    // can't hold is corrupt and is not allocated
+    const quint32 samples = header[1] / 2;
+    if (quint64(samples) > quint64(header[2]) / 2 * GROUP_SAMPLES) return false;
+
+    const auto offset = out.size();
+    out.resize(int(offset + qint64(samples) * SAMPLE_SIZE_BYTES));
+
+    auto in = reinterpret_cast<const quint8*>(block) + HEADER_SIZE;
+    const auto end = reinterpret_cast<const quint8*>(block) + size;
+    auto values = reinterpret_cast<qint16*>(out.data() + offset);
+    qint32 previousI = 0;
+    qint32 previousQ = 0;
+
+    for (quint32 group = 0; group < samples; group += GROUP_SAMPLES)
+    {
+        const quint32 n = std::min(GROUP_SAMPLES, samples - group);
+        if (in + 2 > end)
+        {
+            out.resize(offset);
+            return false;
+        }
+
+        const quint8 descriptorI = *in++;
+        const quint8 descriptorQ = *in++;
+
+        if (!unpack(in, end, descriptorI, n, previousI, values + 2 * group)
+        ||  !unpack(in, end, descriptorQ, n, previousQ, values + 2 * group + 1))
+        {
+            out.resize(offset);
+            return false;
+        }
+    }
+
+    if (in != end)
+    {
+        out.resize(offset);
+        return false;
+    }
+    return true;
+}
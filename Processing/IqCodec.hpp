@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QByteArray>
+
+// Lossless block codec for SC16_Q11 captures.
+//
+// | magic(4) | values count(4) | payload size(4) | payload |
+//
+// Payload is a sequence of groups of GROUP_SAMPLES IQ samples. Each group holds
+// two descriptor bytes (I, Q) followed by the bit-packed I and Q residuals.
+// Descriptor: bit 7 - delta predictor used, bits 0..4 - residual width in bits.
+// Every block starts from a zero predictor state, so blocks decode independently.
+class IqCodec
+{
+public:
+    static constexpr quint32 BLOCK_MAGIC   = 0x315A5149; // "IQZ1"
+    static constexpr quint32 HEADER_SIZE   = 3 * sizeof(quint32);
+    static constexpr quint32 GROUP_SAMPLES = 64;
+
+    /// Encodes count interleaved I/Q values (count is even) into one block
+    static QByteArray encode(const qint16* values, quint32 count);
+
+    /// Worst-case encoded size of a block with count values, 64-bit for untrusted counts
+    static quint64 maxEncodedSize(quint32 count);
+
+    /// Size of the block at data, 0 if the header is incomplete or invalid
+    static quint32 blockSize(const char* data, qint64 available);
+
+    /// Decodes one block, appending the values to out. Returns false on corrupt
+    /// input, out then holds nothing of the block
+    static bool decode(const char* block, quint32 size, QByteArray& out);
+};
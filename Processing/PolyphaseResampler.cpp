@@ -0,0 +1,167 @@
+#include <cmath>
+#include <numeric>
+
+#include "SampleConversion.hpp"
+
+#include "PolyphaseResampler.hpp"
+
+#define KAISER_BETA             8.0     // about 80 dB stopband
+#define PASSBAND                0.9     // of the narrower Nyquist band
+#define OUTPUT_BLOCK            4096
+
+namespace
+{
+
+double besselI0(double x)
+{
+    double sum = 1, term = 1;
+    for (int k = 1; k < 32; ++k)
+    {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+}
+
+PolyphaseResampler::PolyphaseResampler(quint64 inputRate, quint64 outputRate)
+{
+    const auto divisor = std::gcd(inputRate, outputRate);
+    if (divisor == 0) return;
+
+    const quint64 interpolation = outputRate / divisor;
+    const quint64 decimation = inputRate / divisor;
+    if (interpolation > MAX_PHASES || decimation > UINT32_MAX / MAX_PHASES)
+    {
+        mInterpolation = 0;
+        return;
+    }
+
+    mInterpolation = quint32(interpolation);
+    mDecimation = quint32(decimation);
+
+    // The filter has to span the same number of output periods when decimating
+    const quint64 taps = (MIN_TAPS * decimation + interpolation - 1) / interpolation;
+    mTapCount = quint32(std::min<quint64>(std::max<quint64>(taps, MIN_TAPS), MAX_TAPS) + 7) / 8 * 8;
+    mOutI.resize(OUTPUT_BLOCK);
+    mOutQ.resize(OUTPUT_BLOCK);
+
+    design();
+    reset();
+}
+
+bool PolyphaseResampler::valid() const
+{
+    return mInterpolation != 0;
+}
+
+quint32 PolyphaseResampler::interpolation() const
+{
+    return mInterpolation;
+}
+
+quint32 PolyphaseResampler::decimation() const
+{
+    return mDecimation;
+}
+
+quint32 PolyphaseResampler::tapCount() const
+{
+    return mTapCount;
+}
+
+void PolyphaseResampler::push(const qint16* samples, quint32 count)
+{
+    // Samples before the filter span of the next output are not needed anymore
+    const size_t keep = std::min(mBase + 1 - mTapCount, mI.size());
+    mI.erase(mI.begin(), mI.begin() + keep);
+    mQ.erase(mQ.begin(), mQ.begin() + keep);
+    mBase -= keep;
+
+    const size_t offset = mI.size();
+    mI.resize(offset + count);
+    mQ.resize(offset + count);
+
+    for (size_t n = 0; n < count; ++n)
+    {
+        mI[offset + n] = samples[2 * n];
+        mQ[offset + n] = samples[2 * n + 1];
+    }
+}
+
+quint32 PolyphaseResampler::pull(qint16* samples, quint32 count)
+{
+    quint32 produced = 0;
+
+    while (produced < count && mBase < mI.size())
+    {
+        quint32 length = 0;
+
+        while (length < OUTPUT_BLOCK && produced + length < count && mBase < mI.size())
+        {
+            const auto taps = &mTaps[size_t(mPhase) * mTapCount];
+            const auto first = mBase + 1 - mTapCount;
+
+            mOutI[length] = dot(taps, &mI[first]);
+            mOutQ[length] = dot(taps, &mQ[first]);
+            ++length;
+
+            mPhase += mDecimation;
+            mBase += mPhase / mInterpolation;
+            mPhase %= mInterpolation;
+        }
+
+        SampleConversion::planarToSc16(mOutI.data(), mOutQ.data(), samples + 2 * size_t(produced), length, 1.f);
+        produced += length;
+    }
+
+    return produced;
+}
+
+void PolyphaseResampler::reset()
+{
+    // Zero history, the first input sample is the newest one of the first output
+    mI.assign(mTapCount - 1, 0.f);
+    mQ.assign(mTapCount - 1, 0.f);
+    mBase = mTapCount - 1;
+    mPhase = 0;
+}
+
+void PolyphaseResampler::design()
+{
+    const quint32 length = mInterpolation * mTapCount;
+    const double cutoff = PASSBAND * 0.5 / std::max(mInterpolation, mDecimation);   // cycles per upsampled sample
+    const double center = (length - 1) / 2.0;
+    std::vector<double> prototype(length);
+
+    for (quint32 n = 0; n < length; ++n)
+    {
+        const double t = n - center;
+        const double sinc = t == 0 ? 2 * cutoff : std::sin(2 * M_PI * cutoff * t) / (M_PI * t);
+        const double ratio = t / (center + 1);
+        const double window = besselI0(KAISER_BETA * std::sqrt(1 - ratio * ratio)) / besselI0(KAISER_BETA);
+
+        // Every phase sums to about 1, the zeros of the upsampling are made up for
+        prototype[n] = sinc * window * mInterpolation;
+    }
+
+    // y = sum prototype[phase + k * L] * x[base - k], stored as ascending x
+    mTaps.resize(length);
+    for (quint32 phase = 0; phase < mInterpolation; ++phase)
+        for (quint32 j = 0; j < mTapCount; ++j)
+            mTaps[size_t(phase) * mTapCount + j] = float(prototype[size_t(mTapCount - 1 - j) * mInterpolation + phase]);
+}
+
+float PolyphaseResampler::dot(const float* taps, const float* values) const
+{
+    // Separate partial sums per lane need no reassociation, so this vectorizes
+    float partial[8] = {};
+
+    for (quint32 k = 0; k < mTapCount; k += 8)
+        for (quint32 lane = 0; lane < 8; ++lane)
+            partial[lane] += taps[k + lane] * values[k + lane];
+
+    return ((partial[0] + partial[4]) + (partial[1] + partial[5]))
+         + ((partial[2] + partial[6]) + (partial[3] + partial[7]));
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <vector>
+
+// Rational L/M sample rate conversion of SC16_Q11 streams.
+// A Kaiser-windowed sinc prototype is split into L phases; every output sample
+// is one phase dot product over the newest input samples, so upsampled zeros
+// are never computed. History is kept across calls.
+class PolyphaseResampler
+{
+public:
+    static constexpr quint32 MIN_TAPS = 32;     // per phase, more when decimating
+    static constexpr quint32 MAX_TAPS = 512;
+    static constexpr quint32 MAX_PHASES = 1024;
+
+    /// Converts inputRate to outputRate; valid() is false if the ratio needs too many phases
+    PolyphaseResampler(quint64 inputRate, quint64 outputRate);
+
+    bool valid() const;
+    quint32 interpolation() const;
+    quint32 decimation() const;
+    /// Taps per phase; half of them, in input samples, is the filter delay
+    quint32 tapCount() const;
+
+    /// Appends count input samples
+    void push(const qint16* samples, quint32 count);
+    /// Produces up to count output samples from the input pushed so far
+    quint32 pull(qint16* samples, quint32 count);
+    /// Drops the history, as if the stream started anew
+    void reset();
+
+private:
+    void design();
+    float dot(const float* taps, const float* values) const;
+
+private:
+    quint32 mInterpolation = 1;
+    quint32 mDecimation = 1;
+    quint32 mTapCount = MIN_TAPS;       // per phase, multiple of 8
+
+    std::vector<float> mTaps;           // phase-major, reversed to run over ascending input
+    std::vector<float> mI;              // input history and pending samples
+    std::vector<float> mQ;
+    std::vector<float> mOutI;
+    std::vector<float> mOutQ;
+
+    size_t mBase = 0;                   // newest input sample of the next output
+    quint32 mPhase = 0;
+};
@@ -0,0 +1,51 @@
+#include <algorithm>
+
+#include "SampleConversion.hpp"
+
+namespace
+{
+
+// Rounds half up and saturates. Shifted into the positive range first, so
+// truncation rounds and clamping needs no branches: the loops vectorize.
+inline qint16 saturate(float value)
+{
+    value = std::min(std::max(value + (SC16_Q11_MAX + 1.5f), 1.5f), 2 * SC16_Q11_MAX + 1.5f);
+    return qint16(qint32(value) - qint32(SC16_Q11_MAX + 1));
+}
+
+}
+
+void SampleConversion::planarToSc16(const float* i, const float* q, qint16* samples, quint32 count, float scale)
+{
+    for (size_t n = 0; n < count; ++n)
+    {
+        samples[2 * n]     = saturate(i[n] * scale);
+        samples[2 * n + 1] = saturate(q[n] * scale);
+    }
+}
+
+void SampleConversion::cf32ToSc16(const float* values, qint16* samples, quint32 count, float scale)
+{
+    for (size_t n = 0; n < 2 * size_t(count); ++n)
+        samples[n] = saturate(values[n] * scale);
+}
+
+quint32 SampleConversion::scaleSc16(qint16* values, quint32 count, qint32 gain)
+{
+    const auto limit = qint32(SC16_Q11_MAX);
+    quint32 clipped = 0;
+
+    // Fixed point keeps the whole loop in 32-bit integer lanes. Inputs are
+    // bounded to the DAC range first, so the product fits for any gain up to 2^20
+    for (size_t n = 0; n < count; ++n)
+    {
+        const qint32 value = values[n];
+        const qint32 bounded = std::min(std::max(value, -limit), limit);
+        const qint32 scaled = (bounded * gain + (1 << 14)) >> 15;
+        const qint32 limited = std::min(std::max(scaled, -limit), limit);
+        clipped += (value != bounded) | (scaled != limited);
+        values[n] = qint16(limited);
+    }
+
+    return clipped;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <QtGlobal>
+
+// Largest magnitude of an SC16_Q11 component
+inline const float SC16_Q11_MAX = 2047.f;
+
+class SampleConversion
+{
+public:
+    /// Scales separate I and Q arrays into interleaved SC16_Q11 with saturation
+    static void planarToSc16(const float* i, const float* q, qint16* samples, quint32 count, float scale);
+    /// Scales interleaved float I/Q into SC16_Q11 with saturation
+    static void cf32ToSc16(const float* values, qint16* samples, quint32 count, float scale);
+    /// Applies a Q15 gain (at most 2^20, +30 dB) to count values in place with SC16_Q11 saturation,
+    /// returns the clipped ones
+    static quint32 scaleSc16(qint16* values, quint32 count, qint32 gain);
+};
@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "SignalStats.hpp"
+
+#define FLOAT_INFINITY_BITS     0x7F800000
+
+qint32 SignalStats::peak(const qint16* values, quint32 count)
+{
+    qint32 result = 0;
+    for (quint32 i = 0; i < count; ++i)
+        result = std::max(result, std::abs(qint32(values[i])));
+    return result;
+}
+
+float SignalStats::peak(const float* values, quint64 count)
+{
+    // The bit pattern without the sign is std::fabs of the value. Magnitudes up
+    // to infinity order like those integers, NaN patterns lie above infinity and
+    // are skipped. An integer maximum vectorizes without relaxed floating-point rules
+    qint32 result = 0;
+    for (quint64 i = 0; i < count; ++i)
+    {
+        qint32 bits;
+        std::memcpy(&bits, &values[i], sizeof(bits));
+
+        const qint32 magnitude = bits & 0x7FFFFFFF;
+        result = std::max(result, magnitude > FLOAT_INFINITY_BITS ? 0 : magnitude);
+    }
+
+    float peak;
+    std::memcpy(&peak, &result, sizeof(peak));
+    return peak;
+}
+
+void SignalStats::power(const qint16* samples, quint32 count, quint64& sum, quint32& peak)
+{
+    quint64 total = 0;
+    quint32 largest = peak;
+
+    for (size_t n = 0; n < count; ++n)
+    {
+        const qint32 i = samples[2 * n];
+        const qint32 q = samples[2 * n + 1];
+        const auto power = quint32(i * i + q * q);
+
+        total += power;
+        largest = std::max(largest, power);
+    }
+
+    sum += total;
+    peak = largest;
+}
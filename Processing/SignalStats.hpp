@@ -0,0 +1,14 @@
+#pragma once
+
+#include <QtGlobal>
+
+class SignalStats
+{
+public:
+    /// Largest absolute I or Q value of count interleaved values
+    static qint32 peak(const qint16* values, quint32 count);
+    /// Largest absolute value of count floats, NaN is skipped
+    static float peak(const float* values, quint64 count);
+    /// Adds I^2 + Q^2 of count SC16_Q11 samples to sum and raises peak to the largest one
+    static void power(const qint16* samples, quint32 count, quint64& sum, quint32& peak);
+};
@@ -0,0 +1,348 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "SampleConversion.hpp"
+#include "WaveformGenerator.hpp"
+
+#define BLOCK_SAMPLES           4096
+#define NOISE_LANES             8
+
+namespace
+{
+
+const float PI_F = 3.14159265f;
+
+// sin(2 pi t) for t in [-0.5, 0.5]
+inline float sinTurns(float t)
+{
+    // Fold into [-0.25, 0.25] turns, where the odd series converges fast
+    t = std::min(t, 0.5f - t);
+    t = std::max(t, -0.5f - t);
+
+    const float x = 2.f * PI_F * t;
+    const float x2 = x * x;
+    return x * (1.f + x2 * (-1.f / 6 + x2 * (1.f / 120 + x2 * (-1.f / 5040 + x2 * (1.f / 362880 + x2 * (-1.f / 39916800))))));
+}
+
+// Wraps a turn count into [-0.5, 0.5]; conversions instead of branches keep loops vectorizable
+inline float wrapTurns(float t)
+{
+    t -= float(qint32(t));
+    return t - float(qint32(2.f * t));
+}
+
+// Fractional part of a turn count within the qint32 range
+inline float fraction(double t)
+{
+    return float(t - double(qint32(t)));
+}
+
+// ln(x) for normal positive x
+inline float logFast(float x)
+{
+    quint32 bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+
+    const float exponent = float(qint32(bits >> 23) - 127);
+    bits = (bits & 0x007FFFFF) | 0x3F800000;
+
+    float mantissa;
+    std::memcpy(&mantissa, &bits, sizeof(mantissa));
+
+    // ln(m) = 2 atanh((m - 1) / (m + 1)), |z| <= 1/3 for m in [1, 2)
+    const float z = (mantissa - 1.f) / (mantissa + 1.f);
+    const float z2 = z * z;
+    return 0.69314718f * exponent + 2.f * z * (1.f + z2 * (1.f / 3 + z2 * (1.f / 5 + z2 * (1.f / 7 + z2 * (1.f / 9)))));
+}
+
+// PRBS feedback taps (x^order + x^tap + 1)
+quint32 prbsTap(quint32 order)
+{
+    switch (order)
+    {
+        case 7:  return 6;
+        case 9:  return 5;
+        case 11: return 9;
+        case 15: return 14;
+        case 20: return 3;
+        case 23: return 18;
+        case 31: return 28;
+        default: return 0;
+    }
+}
+
+}
+
+WaveformGenerator::WaveformGenerator(const WaveformConfig& config, double sampleRate)
+    : mConfig(config),
+      mSampleRate(sampleRate),
+      mI(BLOCK_SAMPLES),
+      mQ(BLOCK_SAMPLES),
+      mTurns(BLOCK_SAMPLES),
+      mNoise(2 * BLOCK_SAMPLES)
+{
+    if      (config.type == "linear_chirp")      mType = Type::LinearChirp;
+    else if (config.type == "exponential_chirp") mType = Type::ExponentialChirp;
+    else if (config.type == "multitone")         mType = Type::Multitone;
+    else if (config.type == "noise")             mType = Type::Noise;
+    else if (config.type == "bpsk")              mType = Type::Bpsk;
+    else if (config.type == "qpsk")              mType = Type::Qpsk;
+    else                                         mType = Type::Tone;
+
+    mSweepSamples = std::max<quint64>(quint64(config.sweepTime * sampleRate), 1);
+
+    if (mType == Type::ExponentialChirp)
+    {
+        const double ratio = config.stopFrequency / config.startFrequency;
+
+        mExpTable.resize(BLOCK_SAMPLES + 1);
+        for (quint32 n = 0; n <= BLOCK_SAMPLES; ++n)
+            mExpTable[n] = std::expm1(std::log(ratio) * n / double(mSweepSamples));
+    }
+
+    reset();
+}
+
+void WaveformGenerator::generate(qint16* samples, quint32 count)
+{
+    while (count)
+    {
+        const auto length = block(std::min<quint32>(count, BLOCK_SAMPLES));
+
+        SampleConversion::planarToSc16(mI.data(), mQ.data(), samples, length, SC16_Q11_MAX);
+        samples += 2 * size_t(length);
+        count -= length;
+    }
+}
+
+void WaveformGenerator::reset()
+{
+    mPhase = 0;
+    mSweepPosition = 0;
+    mSymbolRemaining = 0;
+
+    // Schroeder phases keep the crest factor of a multitone low
+    const auto tones = mConfig.tones.size();
+    mTonePhases.assign(size_t(tones), 0);
+    for (int k = 0; k < tones; ++k)
+    {
+        const double phase = -0.5 * k * (k - 1) / tones;
+        mTonePhases[size_t(k)] = phase - std::floor(phase);
+    }
+
+    const quint32 order = prbsTap(mConfig.prbsOrder) ? mConfig.prbsOrder : 15;
+    mPrbs = (mConfig.seed & ((1u << order) - 1)) ? mConfig.seed & ((1u << order) - 1) : 1;
+
+    mNoiseState.resize(NOISE_LANES);
+    for (quint32 k = 0; k < NOISE_LANES; ++k)
+        mNoiseState[k] = (mConfig.seed + 1) * 2654435761u + k * 40503u + 1;
+}
+
+quint32 WaveformGenerator::block(quint32 count)
+{
+    const auto amplitude = float(mConfig.amplitude);
+
+    switch (mType)
+    {
+        case Type::Tone:
+            tone(count, mPhase, mConfig.frequency / mSampleRate, amplitude, false);
+        break;
+        case Type::LinearChirp:
+        case Type::ExponentialChirp:
+            count = chirp(count);
+        break;
+        case Type::Multitone:
+        {
+            const auto toneAmplitude = amplitude / float(mConfig.tones.size());
+            for (int k = 0; k < mConfig.tones.size(); ++k)
+                tone(count, mTonePhases[size_t(k)], mConfig.tones.at(k) / mSampleRate, toneAmplitude, k != 0);
+        }
+        break;
+        case Type::Noise:
+            noise(count, float(mConfig.noise), false);
+        break;
+        case Type::Bpsk:
+        case Type::Qpsk:
+            symbols(count);
+        break;
+    }
+
+    if (mConfig.noise > 0 && mType != Type::Noise)
+        noise(count, float(mConfig.noise), true);
+
+    return count;
+}
+
+void WaveformGenerator::tone(quint32 count, double& phase, double step, float amplitude, bool accumulate)
+{
+    // Offsets within a block are wrapped in double, then float turns keep their precision
+    const auto base = float(phase);
+    const double increment = step - std::trunc(step);
+
+    for (quint32 n = 0; n < count; ++n)
+        mTurns[n] = wrapTurns(base + fraction(increment * n));
+
+    turnsToIq(count, amplitude, accumulate);
+
+    phase += (step - std::trunc(step)) * count;
+    phase -= std::floor(phase);
+}
+
+quint32 WaveformGenerator::chirp(quint32 count)
+{
+    // A sweep restart splits the block, the phase stays continuous
+    count = quint32(std::min<quint64>(count, mSweepSamples - mSweepPosition));
+
+    const double t0 = mSweepPosition / mSampleRate;
+    const double duration = mSweepSamples / mSampleRate;
+    const double f0 = mConfig.startFrequency;
+    const double f1 = mConfig.stopFrequency;
+    const auto base = float(mPhase);
+    double advance = 0;
+
+    if (mType == Type::LinearChirp)
+    {
+        // Turns relative to the block start: f n / fs + k / 2 (n / fs)^2
+        const double k = (f1 - f0) / duration;
+        const double f = f0 + k * t0;
+        const double linear = f / mSampleRate;
+        const double quadratic = 0.5 * k / (mSampleRate * mSampleRate);
+
+        for (quint32 n = 0; n < count; ++n)
+            mTurns[n] = wrapTurns(base + fraction(n * (linear + quadratic * n)));
+
+        advance = f * count / mSampleRate + 0.5 * k * std::pow(count / mSampleRate, 2);
+    }
+    else
+    {
+        // f(t) = f0 R^(t / T), turns relative to the block start: f T / ln R (R^(n / N) - 1)
+        const double ratio = f1 / f0;
+        const double f = f0 * std::pow(ratio, t0 / duration);
+        const double coefficient = f * duration / std::log(ratio);
+
+        for (quint32 n = 0; n < count; ++n)
+            mTurns[n] = wrapTurns(base + fraction(coefficient * mExpTable[n]));
+
+        advance = coefficient * mExpTable[count];
+    }
+
+    turnsToIq(count, float(mConfig.amplitude), false);
+
+    mPhase += advance - std::trunc(advance);
+    mPhase -= std::floor(mPhase);
+
+    mSweepPosition += count;
+    if (mSweepPosition >= mSweepSamples) mSweepPosition = 0;
+
+    return count;
+}
+
+void WaveformGenerator::symbols(quint32 count)
+{
+    const double samplesPerSymbol = mSampleRate / mConfig.symbolRate;
+    const auto amplitude = float(mConfig.amplitude);
+    quint32 n = 0;
+
+    while (n < count)
+    {
+        if (mSymbolRemaining <= 0)
+        {
+            if (mType == Type::Bpsk)
+            {
+                mSymbolI = prbsBit() ? amplitude : -amplitude;
+                mSymbolQ = 0;
+            }
+            else
+            {
+                const auto level = amplitude * 0.70710678f;
+                mSymbolI = prbsBit() ? level : -level;
+                mSymbolQ = prbsBit() ? level : -level;
+            }
+            mSymbolRemaining += samplesPerSymbol;
+        }
+
+        const auto run = std::min(count - n, quint32(std::ceil(mSymbolRemaining)));
+        std::fill_n(&mI[n], run, mSymbolI);
+        std::fill_n(&mQ[n], run, mSymbolQ);
+
+        mSymbolRemaining -= run;
+        n += run;
+    }
+}
+
+void WaveformGenerator::noise(quint32 count, float rms, bool accumulate)
+{
+    // Box-Muller over independent xorshift lanes; rms is of the complex value
+    const float scale = rms * 0.70710678f;
+    float* const uniform1 = mNoise.data();
+    float* const uniform2 = mNoise.data() + BLOCK_SAMPLES;
+    quint32 state[NOISE_LANES];
+
+    std::copy(mNoiseState.begin(), mNoiseState.end(), state);
+    for (quint32 n = 0; n < count; n += NOISE_LANES)
+    {
+        for (quint32 k = 0; k < NOISE_LANES; ++k)
+        {
+            quint32 x = state[k];
+            x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+            uniform1[n + k] = 1.f - float(x >> 8) * (1.f / 16777216);
+            x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+            uniform2[n + k] = float(x >> 8) * (1.f / 16777216);
+            state[k] = x;
+        }
+    }
+    std::copy(state, state + NOISE_LANES, mNoiseState.begin());
+
+    for (quint32 n = 0; n < count; ++n)
+    {
+        const float radius = scale * std::sqrt(-2.f * logFast(uniform1[n]));
+        const float angle = wrapTurns(uniform2[n]);
+
+        uniform1[n] = radius * sinTurns(wrapTurns(angle + 0.25f));
+        uniform2[n] = radius * sinTurns(angle);
+    }
+
+    store(uniform1, uniform2, count, accumulate);
+}
+
+void WaveformGenerator::turnsToIq(quint32 count, float amplitude, bool accumulate)
+{
+    float* const i = mNoise.data();
+    float* const q = mNoise.data() + BLOCK_SAMPLES;
+
+    for (quint32 n = 0; n < count; ++n)
+    {
+        i[n] = amplitude * sinTurns(wrapTurns(mTurns[n] + 0.25f));
+        q[n] = amplitude * sinTurns(mTurns[n]);
+    }
+
+    store(i, q, count, accumulate);
+}
+
+void WaveformGenerator::store(const float* i, const float* q, quint32 count, bool accumulate)
+{
+    if (accumulate)
+    {
+        for (quint32 n = 0; n < count; ++n)
+        {
+            mI[n] += i[n];
+            mQ[n] += q[n];
+        }
+    }
+    else
+    {
+        std::copy(i, i + count, mI.begin());
+        std::copy(q, q + count, mQ.begin());
+    }
+}
+
+quint32 WaveformGenerator::prbsBit()
+{
+    const quint32 order = prbsTap(mConfig.prbsOrder) ? mConfig.prbsOrder : 15;
+    const quint32 tap = prbsTap(order);
+    const quint32 bit = ((mPrbs >> (order - 1)) ^ (mPrbs >> (tap - 1))) & 1;
+
+    mPrbs = ((mPrbs << 1) | bit) & ((1u << order) - 1);
+    return bit;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QtGlobal>
+
+#include <vector>
+
+#include "Types/WaveformConfig.hpp"
+
+// Endless SC16_Q11 waveform synthesis, phase-continuous across calls.
+// Samples are produced in float blocks by per-sample independent loops
+// (phases are computed relative to the block start), which the compiler
+// vectorizes, and converted with saturation at the end.
+class WaveformGenerator
+{
+public:
+    WaveformGenerator(const WaveformConfig& config, double sampleRate);
+
+    void generate(qint16* samples, quint32 count);
+    void reset();
+
+private:
+    enum class Type
+    {
+        Tone,
+        LinearChirp,
+        ExponentialChirp,
+        Multitone,
+        Noise,
+        Bpsk,
+        Qpsk
+    };
+
+    quint32 block(quint32 count);
+
+    void tone(quint32 count, double& phase, double step, float amplitude, bool accumulate);
+    quint32 chirp(quint32 count);
+    void symbols(quint32 count);
+    void noise(quint32 count, float rms, bool accumulate);
+
+    void turnsToIq(quint32 count, float amplitude, bool accumulate);
+    void store(const float* i, const float* q, quint32 count, bool accumulate);
+    quint32 prbsBit();
+
+private:
+    const WaveformConfig mConfig;
+    const double mSampleRate;
+    Type mType = Type::Tone;
+
+    std::vector<float> mI;
+    std::vector<float> mQ;
+    std::vector<float> mTurns;
+    std::vector<float> mNoise;          // I and Q scratch, BLOCK_SAMPLES each
+    std::vector<double> mExpTable;      // R^(n / sweep samples) - 1 of the exponential chirp
+
+    // Phases are kept in turns, [0, 1)
+    double mPhase = 0;
+    std::vector<double> mTonePhases;
+
+    quint64 mSweepSamples = 0;
+    quint64 mSweepPosition = 0;
+
+    quint32 mPrbs = 1;
+    double mSymbolRemaining = 0;
+    float mSymbolI = 0;
+    float mSymbolQ = 0;
+
+    std::vector<quint32> mNoiseState;
+};
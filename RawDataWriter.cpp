@@ -1,39 +1,390 @@
+#include <QThreadPool>
+#include <QThread>
+#include <QFileInfo>
 #include <QFile>
 #include <QDir>
 
+#include "Processing/SignalStats.hpp"
+#include "Processing/IqCodec.hpp"
+#include "Types/CaptureMetadata.hpp"
+#include "Types/CrcSidecar.hpp"
+#include "Types/RawDataQueue.hpp"
 #include "Types/RawData.hpp"
 
 #include "RawDataWriter.hpp"
 
-RawDataWriter::RawDataWriter(QObject* parent)
-    : QObject(parent)
+#define CAPTURE_METADATA_FILE   "capture.json"
+
+RawDataWriter::RawDataWriter(const MissionConfig& config, QObject* parent)
+    : QObject(parent),
+      mConfig(config),
+      mQueue(new RawDataQueue(config.writerQueue, RawDataQueue::policyFromString(config.overloadPolicy)))
 {
 
 }
 
+RawDataWriter::~RawDataWriter()
+{
+    drain();
+    mQueue->close();
+
+    if (mSpillThread)
+    {
+        mSpillThread->join();
+        delete mSpillThread;
+    }
+
+    flushCompressed(true);
+    qDeleteAll(mSidecars);
+    saveMetadata();
+
+    delete mQueue;
+}
+
+void RawDataWriter::enqueue(const RawData& data)
+{
+    if (mQueue->push(data))
+        QMetaObject::invokeMethod(this, &RawDataWriter::drain, Qt::QueuedConnection);
+}
+
 void RawDataWriter::init()
 {
-    const auto openFile = [this](QFile*& file, int index) {
-        const QString path(QDir::current().absoluteFilePath("rx%1.bin"));
-        if (file) file->deleteLater();
-        file = new QFile(path.arg(index), this);
+    qInfo("Writer queue: %u buffers, %s on overload",
+          mConfig.writerQueue, qPrintable(mConfig.overloadPolicy));
+
+    if (RawDataQueue::policyFromString(mConfig.overloadPolicy) == OverloadPolicy::Spill && !mSpillThread)
+        mSpillThread = new std::thread(&RawDataWriter::spill, this);
+
+    if (mConfig.compression && !mCompressionPool)
+    {
+        mCompressionPool = new QThreadPool(this);
+        mCompressionPool->setMaxThreadCount(mConfig.compressionThreads ? int(mConfig.compressionThreads)
+                                                                       : QThread::idealThreadCount());
+        qInfo("Capture compression enabled, %i threads", mCompressionPool->maxThreadCount());
+    }
+
+    if (mConfig.eventCapture)
+    {
+        // 64-bit, valid() keeps the result within MAX_PRE_ROLL_BYTES
+        const quint64 preRollBytes = quint64(mConfig.eventPreRoll * mConfig.sampleRate) * SAMPLE_SIZE_BYTES;
+
+        mPreTrigger.reset(quint32(std::min<quint64>(preRollBytes, MAX_PRE_ROLL_BYTES)));
+        qInfo("Event capture: %.3f s pre-roll, %.3f s post-roll",
+              mConfig.eventPreRoll, mConfig.eventPostRoll);
+        return;
+    }
+
+    openFile(mRx1, "rx1");
+    openFile(mRx2, "rx2");
+    trackPart();
+}
+
+void RawDataWriter::drain()
+{
+    RawData data;
+    while (mQueue->pop(data))
+        process(data);
+}
+
+void RawDataWriter::process(const RawData& data)
+{
+    ++mBuffersWritten;
 
+    if (mConfig.eventCapture)
+    {
+        onEventData(data);
+        return;
+    }
+
+    if (data.frequency()) trackSegment(data);
+    if (mConfig.dutyOn) trackWindow(data);
+
+    write(mRx1, data.rx1());
+    write(mRx2, data.rx2());
+    flushCompressed(false);
+    mSamplesWritten += data.samplesCount();
+}
+
+void RawDataWriter::trackSegment(const RawData& data)
+{
+    // Buffers are stamped from the first live retune on, what came before is
+    // the session frequency
+    if (mSegments.isEmpty() && mSamplesWritten)
+        mSegments.append({ mConfig.frequency, 0, 0, mSamplesWritten });
+
+    // A dropped buffer does not break a segment, its file offsets stay contiguous
+    if (!mSegments.isEmpty() && mSegments.last().frequency == data.frequency())
+    {
+        mSegments.last().samples += data.samplesCount();
+        return;
+    }
+
+    mSegments.append({ data.frequency(), data.index(), mSamplesWritten, data.samplesCount() });
+}
+
+void RawDataWriter::trackWindow(const RawData& data)
+{
+    // Parts of one window come in consecutive buffers
+    if (!mWindows.isEmpty() && mWindows.last().streamOffset + mWindows.last().samples == data.sampleOffset())
+    {
+        mWindows.last().samples += data.samplesCount();
+        return;
+    }
+
+    mWindows.append({ data.sampleOffset(), data.timestamp(), mSamplesWritten, data.samplesCount() });
+}
+
+void RawDataWriter::trackPart()
+{
+    // Offsets of segments and windows run on across the parts
+    mParts.append({ QFileInfo(mRx1->fileName()).fileName(),
+                    QFileInfo(mRx2->fileName()).fileName(),
+                    mSamplesWritten });
+}
+
+void RawDataWriter::onTrigger()
+{
+    if (!mConfig.eventCapture) return;
+
+    const quint64 postRollSamples = mConfig.eventPostRoll * mConfig.sampleRate;
+    const bool recording = mPostRollBytes > 0;
+
+    mPostRollBytes = postRollSamples * SAMPLE_SIZE_BYTES;
+
+    if (recording) return; // retrigger only extends the post-roll
+
+    eventStart();
+    if (mPostRollBytes == 0) eventFinish();
+}
+
+void RawDataWriter::rotate()
+{
+    if (mConfig.eventCapture || !mRx1) return;
+
+    const auto suffix = QString("_part%1").arg(++mPartIndex, 4, 10, QChar('0'));
+
+    flushCompressed(true);
+    openFile(mRx1, "rx1" + suffix);
+    openFile(mRx2, "rx2" + suffix);
+    trackPart();
+
+    qInfo("Capture continues in part %u after %llu samples", mPartIndex, mSamplesWritten);
+}
+
+void RawDataWriter::spill()
+{
+    // Overflow goes raw to the secondary disk together with buffer indices,
+    // so it can be merged back into the capture afterwards
+    QDir spillDir(mConfig.spillPath);
+    if (!mConfig.outputDirectory.isEmpty())
+    {
+        spillDir.mkpath(mConfig.outputDirectory);
+        spillDir.cd(mConfig.outputDirectory);
+    }
+    QFile rx1(spillDir.absoluteFilePath("rx1.spill.bin"));
+    QFile rx2(spillDir.absoluteFilePath("rx2.spill.bin"));
+    QFile index(spillDir.absoluteFilePath("spill.idx"));
+    CrcSidecar rx1Crc(rx1.fileName(), mConfig.crcBlockSize);
+    CrcSidecar rx2Crc(rx2.fileName(), mConfig.crcBlockSize);
+
+    for (auto file : { &rx1, &rx2, &index })
         if (!file->open(QIODevice::WriteOnly))
-            qFatal("Can't open file %s for write: %s",
+            qFatal("Can't open spill file %s for write: %s",
                    qPrintable(file->fileName()),
                    qPrintable(file->errorString()));
-    };
 
-    openFile(mRx1, 1);
-    openFile(mRx2, 2);
+    const bool checksums = mConfig.crcBlockSize && rx1Crc.open() && rx2Crc.open();
+
+    RawData data;
+    while (mQueue->popSpilled(data))
+    {
+        const quint32 bufferIndex = data.index();
+        const auto rx1Data = data.rx1();
+        const auto rx2Data = data.rx2();
+
+        rx1.write(rx1Data);
+        rx2.write(rx2Data);
+        index.write(reinterpret_cast<const char*>(&bufferIndex), sizeof(bufferIndex));
+
+        if (checksums)
+        {
+            rx1Crc.update(rx1Data.constData(), rx1Data.size());
+            rx2Crc.update(rx2Data.constData(), rx2Data.size());
+        }
+    }
 }
 
-void RawDataWriter::onData(const RawData& data)
+void RawDataWriter::saveMetadata()
 {
-    const auto write = [](QFile* file, const QByteArray& data) {
-        if (file && !data.isEmpty()) file->write(data);
-    };
+    CaptureMetadata metadata;
+    QFile file(mConfig.outputPath(CAPTURE_METADATA_FILE));
 
-    write(mRx1, data.rx1());
-    write(mRx2, data.rx2());
+    metadata.sampleRate = mConfig.sampleRate;
+    metadata.frequency = mConfig.frequency;
+    metadata.samplesPerBuffer = mConfig.samplesCount;
+    metadata.duplex = mConfig.direction == Direction::Duplex;
+    metadata.overloadPolicy = mConfig.overloadPolicy;
+    metadata.writerQueue = mConfig.writerQueue;
+    metadata.queueHighWatermark = mQueue->highWatermark();
+    metadata.buffersWritten = mBuffersWritten;
+    metadata.buffersDropped = mQueue->dropped();
+    metadata.buffersSpilled = mQueue->spilled();
+    metadata.droppedRanges = mQueue->droppedRanges();
+    metadata.segments = mSegments;
+    metadata.dutyOn = mConfig.dutyOn;
+    metadata.dutyOff = mConfig.dutyOff;
+    metadata.windows = mWindows;
+    metadata.parts = mParts;
+
+    if (metadata.buffersDropped)
+        qWarning("Writer overload: %llu buffers dropped", metadata.buffersDropped);
+
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning("Can't save capture metadata: %s", qPrintable(file.errorString()));
+        return;
+    }
+    file.write(metadata.raw(QJsonDocument::Indented));
+}
+
+void RawDataWriter::openFile(QFile*& file, const QString& name)
+{
+    const QString path(mConfig.outputPath(name + (mConfig.compression ? ".iqz" : ".bin")));
+    closeFile(file);
+    file = new QFile(path, this);
+
+    if (!file->open(QIODevice::WriteOnly))
+        qFatal("Can't open file %s for write: %s",
+               qPrintable(file->fileName()),
+               qPrintable(file->errorString()));
+
+    if (mConfig.crcBlockSize)
+    {
+        const auto sidecar = new CrcSidecar(path, mConfig.crcBlockSize);
+        if (!sidecar->open())
+            qFatal("Can't open file %s for write: %s",
+                   qPrintable(CrcSidecar::path(path)),
+                   qPrintable(sidecar->errorString()));
+        mSidecars.insert(file, sidecar);
+    }
+}
+
+void RawDataWriter::closeFile(QFile*& file)
+{
+    if (!file) return;
+
+    delete mSidecars.take(file);
+    file->close();
+    file->deleteLater();
+    file = nullptr;
+}
+
+void RawDataWriter::write(QFile* file, const QByteArray& data)
+{
+    if (!file || data.isEmpty()) return;
+
+    if (mCompressionPool) compress(file, data);
+    else writeFile(file, data);
+}
+
+void RawDataWriter::writeFile(QFile* file, const QByteArray& data)
+{
+    file->write(data);
+
+    if (const auto sidecar = mSidecars.value(file))
+        sidecar->update(data.constData(), data.size());
+}
+
+void RawDataWriter::compress(QFile* file, const QByteArray& data)
+{
+    const auto task = std::make_shared<std::packaged_task<QByteArray()>>([data]() {
+        return IqCodec::encode(reinterpret_cast<const qint16*>(data.constData()),
+                               data.size() / sizeof(qint16));
+    });
+
+    mCompressedBlocks.push_back({ file, task->get_future() });
+    mCompressionPool->start([task]() { (*task)(); });
+}
+
+void RawDataWriter::flushCompressed(bool wait)
+{
+    // Blocks are written strictly in submission order. The writer only waits
+    // for a block when the pool is saturated, otherwise it takes what is ready.
+    const size_t limit = (wait || !mCompressionPool) ? 0 : 2 * mCompressionPool->maxThreadCount();
+
+    while (!mCompressedBlocks.empty())
+    {
+        auto& block = mCompressedBlocks.front();
+
+        if (mCompressedBlocks.size() <= limit
+        &&  block.data.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            break;
+
+        writeFile(block.file, block.data.get());
+        mCompressedBlocks.pop_front();
+    }
+}
+
+void RawDataWriter::onEventData(const RawData& data)
+{
+    if (mPostRollBytes > 0)
+    {
+        const auto length = int(std::min<quint64>(mPostRollBytes, data.rxSize()));
+
+        write(mRx1, data.rx1().left(length));
+        write(mRx2, data.rx2().left(length));
+        flushCompressed(false);
+
+        mPostRollBytes -= length;
+        if (mPostRollBytes == 0) eventFinish();
+    }
+
+    mPreTrigger.push(data.rx1(), data.rx2());
+
+    if (mConfig.eventLevel)
+    {
+        const auto peak = [](const QByteArray& rx) {
+            return SignalStats::peak(reinterpret_cast<const qint16*>(rx.constData()), rx.size() / sizeof(qint16));
+        };
+
+        if (std::max(peak(data.rx1()), peak(data.rx2())) >= mConfig.eventLevel)
+            onTrigger();
+    }
+}
+
+void RawDataWriter::eventStart()
+{
+    const quint32 blockBytes = mConfig.samplesCount * SAMPLE_SIZE_BYTES;
+    const quint32 preRollBytes = mPreTrigger.size();
+    const auto suffix = QString("_event%1").arg(++mEventIndex, 4, 10, QChar('0'));
+
+    openFile(mRx1, "rx1" + suffix);
+    openFile(mRx2, "rx2" + suffix);
+    trackPart();
+
+    // Pre-roll goes out in capture-sized blocks, so compressed events look like live data
+    for (quint32 offset = 0; offset < preRollBytes; offset += blockBytes)
+    {
+        const quint32 length = std::min(blockBytes, preRollBytes - offset);
+        QByteArray rx1(length, Qt::Uninitialized);
+        QByteArray rx2(length, Qt::Uninitialized);
+
+        mPreTrigger.read(1, offset, rx1.data(), length);
+        mPreTrigger.read(2, offset, rx2.data(), length);
+
+        write(mRx1, rx1);
+        write(mRx2, rx2);
+        flushCompressed(false);
+    }
+
+    qInfo("Event %u triggered, %u pre-roll samples saved", mEventIndex, preRollBytes / SAMPLE_SIZE_BYTES);
+}
+
+void RawDataWriter::eventFinish()
+{
+    flushCompressed(true);
+    closeFile(mRx1);
+    closeFile(mRx2);
+
+    qInfo("Event %u saved", mEventIndex);
 }
@@ -2,23 +2,89 @@
 #define RAWDATAWRITER_HPP
 
 #include <QObject>
+#include <QHash>
+
+#include <deque>
+#include <future>
+#include <thread>
+
+#include "Types/CaptureMetadata.hpp"
+#include "Types/MissionConfig.hpp"
+#include "Types/PreTriggerRing.hpp"
 
 class QFile;
+class CrcSidecar;
+class QThreadPool;
 class RawData;
+class RawDataQueue;
 
 class RawDataWriter : public QObject
 {
     Q_OBJECT
 public:
-    RawDataWriter(QObject* parent = nullptr);
+    RawDataWriter(const MissionConfig& config, QObject* parent = nullptr);
+    ~RawDataWriter();
+
+    /// Called on the RX stream thread, applies the overload policy
+    void enqueue(const RawData& data);
 
 public slots:
     void init();
-    void onData(const RawData& data);
+    void onTrigger();
+    /// Continues the capture in a new pair of files
+    void rotate();
+
+private slots:
+    void drain();
+
+private:
+    void process(const RawData& data);
+    void spill();
+    void saveMetadata();
+
+    void openFile(QFile*& file, const QString& name);
+    void closeFile(QFile*& file);
+    void write(QFile* file, const QByteArray& data);
+    void writeFile(QFile* file, const QByteArray& data);
+    void compress(QFile* file, const QByteArray& data);
+    void flushCompressed(bool wait);
+
+    void trackSegment(const RawData& data);
+    void trackWindow(const RawData& data);
+    void trackPart();
+
+    void onEventData(const RawData& data);
+    void eventStart();
+    void eventFinish();
 
 private:
+    struct CompressedBlock
+    {
+        QFile* file;
+        std::future<QByteArray> data;
+    };
+
+    MissionConfig mConfig;
+
+    RawDataQueue* mQueue = nullptr;
+    std::thread* mSpillThread = nullptr;
+    quint64 mBuffersWritten = 0;
+    quint64 mSamplesWritten = 0;
+    QList<CaptureMetadata::Segment> mSegments;
+    QList<CaptureMetadata::Window> mWindows;
+    QList<CaptureMetadata::Part> mParts;
+
     QFile* mRx1 = nullptr;
     QFile* mRx2 = nullptr;
+    QHash<QFile*, CrcSidecar*> mSidecars;
+
+    QThreadPool* mCompressionPool = nullptr;
+    std::deque<CompressedBlock> mCompressedBlocks;
+
+    PreTriggerRing mPreTrigger;
+    quint64 mPostRollBytes = 0;
+    unsigned mEventIndex = 0;
+    unsigned mPartIndex = 0;
 };
 
 #endif // RAWDATAWRITER_HPP
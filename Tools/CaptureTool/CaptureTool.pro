@@ -0,0 +1,26 @@
+QT -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = capture_tool
+
+LIBS += -lrt
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../Processing/Crc32c.cpp \
+    ../../Processing/IqCodec.cpp \
+    ../../Processing/SignalStats.cpp \
+    ../../Types/CrcSidecar.cpp \
+    ../../Types/SharedMemoryRing.cpp \
+    main.cpp
+
+HEADERS += \
+    ../../Processing/Crc32c.hpp \
+    ../../Processing/IqCodec.hpp \
+    ../../Processing/SignalStats.hpp \
+    ../../Types/CrcSidecar.hpp \
+    ../../Types/RawData.hpp \
+    ../../Types/SharedMemoryRing.hpp
@@ -0,0 +1,357 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+
+#include <algorithm>
+#include <cerrno>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "Processing/Crc32c.hpp"
+#include "Processing/IqCodec.hpp"
+#include "Processing/SignalStats.hpp"
+#include "Types/CrcSidecar.hpp"
+#include "Types/RawData.hpp"
+#include "Types/SharedMemoryRing.hpp"
+
+#define BENCH_BLOCK_SAMPLES     16384
+#define DECODE_FLUSH_BYTES      (64 * 1024 * 1024)
+#define VERIFY_CHUNK_BLOCKS     16
+#define VERIFY_REPORT_LIMIT     16
+#define SHM_POLL_INTERVAL_US    200
+
+int decode(const QString& inputPath, const QString& outputPath);
+int bench(int threads, int seconds, const QString& samplePath);
+int verify(const QStringList& paths);
+int shm(const QString& name, int seconds);
+
+int main(int argc, char** argv)
+{
+    const QCoreApplication application(argc, argv);
+    const auto arguments = application.arguments();
+    const auto command = arguments.value(1);
+
+    if (command == "decode" && arguments.size() == 4)
+        return decode(arguments[2], arguments[3]);
+    if (command == "bench")
+        return bench(arguments.value(2).toInt(), arguments.value(3, "5").toInt(), arguments.value(4));
+    if (command == "verify" && arguments.size() > 2)
+        return verify(arguments.mid(2));
+    if (command == "shm" && arguments.size() > 2)
+        return shm(arguments[2], arguments.value(3, "0").toInt());
+
+    qInfo("Usage:\n"
+          "  %s decode <rx.iqz> <rx.bin>\n"
+          "  %s bench [threads] [seconds] [rx.bin]\n"
+          "  %s verify <rx.bin> [rx.bin ...]\n"
+          "  %s shm <name> [seconds]",
+          qPrintable(arguments.value(0)), qPrintable(arguments.value(0)),
+          qPrintable(arguments.value(0)), qPrintable(arguments.value(0)));
+    return -1;
+}
+
+int decode(const QString& inputPath, const QString& outputPath)
+{
+    QFile input(inputPath);
+    QFile output(outputPath);
+
+    if (!input.open(QIODevice::ReadOnly))
+    {
+        qWarning("Can't open %s: %s", qPrintable(inputPath), qPrintable(input.errorString()));
+        return -1;
+    }
+    if (!output.open(QIODevice::WriteOnly))
+    {
+        qWarning("Can't open %s: %s", qPrintable(outputPath), qPrintable(output.errorString()));
+        return -1;
+    }
+
+    const qint64 size = input.size();
+    const auto data = reinterpret_cast<const char*>(input.map(0, size));
+    if (!data && size)
+    {
+        qWarning("Can't map %s: %s", qPrintable(inputPath), qPrintable(input.errorString()));
+        return -1;
+    }
+
+    QByteArray decoded;
+    qint64 offset = 0;
+    qint64 blocks = 0;
+    qint64 corrupted = 0;
+    qint64 written = 0;
+
+    while (offset < size)
+    {
+        const qint64 blockSize = IqCodec::blockSize(data + offset, size - offset);
+
+        if (blockSize == 0
+        ||  offset + blockSize > size
+        || !IqCodec::decode(data + offset, blockSize, decoded))
+        {
+            // Blocks are independent, so resynchronise on the next block magic
+            qWarning("Corrupted block at offset %lli", offset);
+            ++corrupted;
+
+            const char magic[] = { 'I', 'Q', 'Z', '1' };
+            const auto from = data + offset + 1;
+            const auto next = std::search(from, data + size, magic, magic + sizeof(magic));
+            offset = next - data;
+            continue;
+        }
+
+        offset += blockSize;
+        ++blocks;
+
+        if (decoded.size() >= DECODE_FLUSH_BYTES)
+        {
+            written += output.write(decoded);
+            decoded.clear();
+        }
+    }
+    written += output.write(decoded);
+
+    qInfo("%lli blocks decoded, %lli corrupted, %lli -> %lli bytes", blocks, corrupted, size, written);
+    return corrupted ? -1 : 0;
+}
+
+int bench(int threads, int seconds, const QString& samplePath)
+{
+    std::vector<qint16> values(2 * BENCH_BLOCK_SAMPLES);
+
+    if (threads <= 0) threads = int(std::thread::hardware_concurrency());
+    if (seconds <= 0) seconds = 1;
+
+    if (!samplePath.isEmpty())
+    {
+        QFile sample(samplePath);
+        if (!sample.open(QIODevice::ReadOnly)
+        ||  sample.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(qint16))
+                != qint64(values.size() * sizeof(qint16)))
+        {
+            qWarning("Can't read %i samples from %s", BENCH_BLOCK_SAMPLES, qPrintable(samplePath));
+            return -1;
+        }
+    }
+    else
+    {
+        // Noise-dominated 12-bit capture
+        std::mt19937 generator(0);
+        std::normal_distribution<float> noise(0.f, 256.f);
+        for (auto& value : values)
+            value = qint16(std::clamp(noise(generator), -2048.f, 2047.f));
+    }
+
+    const auto block = IqCodec::encode(values.data(), values.size());
+    QByteArray decoded;
+
+    if (!IqCodec::decode(block.constData(), block.size(), decoded)
+    ||  std::memcmp(decoded.constData(), values.data(), decoded.size()) != 0)
+    {
+        qWarning("Round trip failed");
+        return -1;
+    }
+
+    std::atomic_bool process(true);
+    std::atomic<qint64> encodedBlocks(0);
+    std::vector<std::thread> workers;
+    QElapsedTimer timer;
+
+    timer.start();
+    for (int i = 0; i < threads; ++i)
+        workers.emplace_back([&]() {
+            while (process.load(std::memory_order_relaxed))
+            {
+                IqCodec::encode(values.data(), values.size());
+                encodedBlocks.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    process.store(false);
+    for (auto& worker : workers) worker.join();
+
+    const double encodeSeconds = timer.nsecsElapsed() / 1e9;
+    qint64 decodedBlocks = 0;
+
+    timer.restart();
+    while (timer.elapsed() < 1000)
+    {
+        decoded.clear();
+        if (!IqCodec::decode(block.constData(), block.size(), decoded))
+        {
+            qWarning("Benchmark block does not decode");
+            return -1;
+        }
+        ++decodedBlocks;
+    }
+
+    const double decodeSeconds = timer.nsecsElapsed() / 1e9;
+    const double blockBytes = values.size() * sizeof(qint16);
+
+    qInfo("Compression ratio: %.3f", block.size() / blockBytes);
+    qInfo("Encode: %i threads, %.1f MS/s, %.0f MB/s",
+          threads,
+          encodedBlocks * BENCH_BLOCK_SAMPLES / encodeSeconds / 1e6,
+          encodedBlocks * blockBytes / encodeSeconds / 1e6);
+    qInfo("Decode: 1 thread, %.1f MS/s, %.0f MB/s",
+          decodedBlocks * BENCH_BLOCK_SAMPLES / decodeSeconds / 1e6,
+          decodedBlocks * blockBytes / decodeSeconds / 1e6);
+
+    return 0;
+}
+
+bool verifyFile(const QString& path)
+{
+    QFile data(path);
+    QFile sidecar(CrcSidecar::path(path));
+
+    if (!data.open(QIODevice::ReadOnly) || !sidecar.open(QIODevice::ReadOnly))
+    {
+        qWarning("%s: can't open: %s %s", qPrintable(path),
+                 qPrintable(data.errorString()), qPrintable(sidecar.errorString()));
+        return false;
+    }
+
+    const auto records = sidecar.readAll();
+    quint32 header[2] = { 0, 0 };
+    if (records.size() >= qint64(CrcSidecar::HEADER_SIZE))
+        std::memcpy(header, records.constData(), CrcSidecar::HEADER_SIZE);
+
+    if (header[0] != CrcSidecar::MAGIC || header[1] == 0)
+    {
+        qWarning("%s: invalid sidecar", qPrintable(path));
+        return false;
+    }
+
+    const quint32 blockSize = header[1];
+    const qint64 size = data.size();
+    const qint64 blocks = (size + blockSize - 1) / blockSize;
+    const qint64 recorded = (records.size() - CrcSidecar::HEADER_SIZE) / sizeof(quint32);
+    const auto expected = reinterpret_cast<const quint32*>(records.constData() + CrcSidecar::HEADER_SIZE);
+    const auto bytes = reinterpret_cast<const char*>(data.map(0, size));
+
+    if (!bytes && size)
+    {
+        qWarning("%s: can't map: %s", qPrintable(path), qPrintable(data.errorString()));
+        return false;
+    }
+
+    std::atomic<qint64> nextBlock(0);
+    std::mutex mismatchesMutex;
+    std::vector<qint64> mismatches;
+    std::vector<std::thread> workers;
+    const qint64 checked = std::min(blocks, recorded);
+
+    for (unsigned i = 0; i < std::max(1u, std::thread::hardware_concurrency()); ++i)
+        workers.emplace_back([&]() {
+            for (qint64 first = nextBlock.fetch_add(VERIFY_CHUNK_BLOCKS); first < checked;
+                 first = nextBlock.fetch_add(VERIFY_CHUNK_BLOCKS))
+            {
+                for (qint64 block = first; block < std::min<qint64>(first + VERIFY_CHUNK_BLOCKS, checked); ++block)
+                {
+                    const qint64 offset = block * blockSize;
+                    const auto length = size_t(std::min<qint64>(blockSize, size - offset));
+
+                    if (Crc32c::update(0, bytes + offset, length) != expected[block])
+                    {
+                        const std::lock_guard<std::mutex> lock(mismatchesMutex);
+                        mismatches.push_back(block);
+                    }
+                }
+            }
+        });
+    for (auto& worker : workers) worker.join();
+
+    std::sort(mismatches.begin(), mismatches.end());
+    for (size_t i = 0; i < std::min<size_t>(mismatches.size(), VERIFY_REPORT_LIMIT); ++i)
+        qWarning("%s: block %lli at offset %lli corrupted", qPrintable(path),
+                 mismatches[i], mismatches[i] * blockSize);
+
+    if (recorded != blocks)
+        qWarning("%s: %lli blocks, but %lli integrity records", qPrintable(path), blocks, recorded);
+
+    const bool valid = mismatches.empty() && recorded == blocks;
+    qInfo("%s: %lli of %lli blocks verified, %zu corrupted%s", qPrintable(path),
+          checked - qint64(mismatches.size()), blocks, mismatches.size(), valid ? "" : " - FAILED");
+    return valid;
+}
+
+int verify(const QStringList& paths)
+{
+    int failed = 0;
+
+    qInfo("CRC32C %s", Crc32c::hardwareAccelerated() ? "hardware accelerated" : "in software");
+    for (const auto& path : paths)
+        if (!verifyFile(path)) ++failed;
+
+    return failed ? -1 : 0;
+}
+
+int shm(const QString& name, int seconds)
+{
+    SharedMemoryRing ring;
+
+    if (!ring.attach(qPrintable(name)))
+    {
+        qWarning("Can't attach to shared memory ring %s: %s", qPrintable(name), strerror(errno));
+        return -1;
+    }
+
+    const auto header = ring.header();
+    qInfo("%s: %u slots, %u bytes per channel, %llu S/s",
+          qPrintable(name), header->slotCount, header->channelBytes,
+          static_cast<unsigned long long>(header->sampleRate));
+
+    SharedMemoryRing::View view;
+    uint64_t sequence = ring.head() + 1;
+    qint64 buffers = 0, bytes = 0, overruns = 0, torn = 0;
+    qint32 peak = 0;
+    QElapsedTimer total, report;
+
+    total.start();
+    report.start();
+    while (seconds <= 0 || total.elapsed() < seconds * 1000ll)
+    {
+        switch (ring.read(sequence, view))
+        {
+            case SharedMemoryRing::ReadStatus::NoData:
+                std::this_thread::sleep_for(std::chrono::microseconds(SHM_POLL_INTERVAL_US));
+            break;
+            case SharedMemoryRing::ReadStatus::Overrun:
+                ++overruns;
+            break;
+            case SharedMemoryRing::ReadStatus::Ok:
+            {
+                const qint32 viewPeak = SignalStats::peak(reinterpret_cast<const qint16*>(view.rx1),
+                                                          view.bytes / sizeof(qint16));
+                if (ring.valid(view))
+                {
+                    peak = std::max(peak, viewPeak);
+                    bytes += view.bytes;
+                    ++buffers;
+                }
+                else ++torn;
+                ++sequence;
+            }
+            break;
+        }
+
+        if (report.elapsed() >= 1000)
+        {
+            qInfo("sequence %llu: %.1f MS/s, peak %i, %lli overruns, %lli torn",
+                  static_cast<unsigned long long>(sequence - 1),
+                  bytes / SAMPLE_SIZE_BYTES / (report.nsecsElapsed() / 1e9) / 1e6,
+                  peak, overruns, torn);
+            report.restart();
+            bytes = 0;
+            peak = 0;
+        }
+    }
+
+    qInfo("%lli buffers read, %lli overruns, %lli torn", buffers, overruns, torn);
+    return 0;
+}
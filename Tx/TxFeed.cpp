@@ -0,0 +1,169 @@
+#include <cstring>
+
+#include "Types/RawData.hpp"
+
+#include "TxSource.hpp"
+#include "TxFeed.hpp"
+
+#define MIN_PRODUCE_SAMPLES     4096
+#define PRODUCER_WAIT_MS        2
+
+TxFeed::TxFeed(TxSource* source, quint32 capacity, EndOfSource endOfSource)
+    : mSource(source),
+      mCapacity(std::max<quint32>(capacity, MIN_PRODUCE_SAMPLES)),
+      mEndOfSource(endOfSource),
+      mRing(2 * size_t(mCapacity)),
+      mWritten(0),
+      mRead(0),
+      mSourceEnded(false),
+      mLowWatermark(UINT32_MAX),
+      mProcess(false)
+{
+
+}
+
+TxFeed::~TxFeed()
+{
+    stop();
+    delete mSource;
+}
+
+bool TxFeed::start(quint32 preRoll)
+{
+    if (!mSource->open()) return false;
+
+    // The producer rests once less than MIN_PRODUCE_SAMPLES are free
+    const quint32 required = (preRoll && preRoll < mCapacity - MIN_PRODUCE_SAMPLES)
+                           ? preRoll
+                           : mCapacity - MIN_PRODUCE_SAMPLES + 1;
+
+    mProcess.store(true);
+    mThread = new std::thread(&TxFeed::process, this);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mFilled.wait(lock, [this, required]() { return mSourceEnded.load() || available() >= required; });
+    return true;
+}
+
+void TxFeed::stop()
+{
+    if (!mThread) return;
+
+    mProcess.store(false);
+    mSpaceAvailable.notify_all();
+    mThread->join();
+
+    delete mThread;
+    mThread = nullptr;
+}
+
+quint32 TxFeed::pop(qint16* samples, quint32 count)
+{
+    const quint64 read = mRead.load(std::memory_order_relaxed);
+    const quint64 written = mWritten.load(std::memory_order_acquire);
+    const auto length = quint32(std::min<quint64>(count, written - read));
+
+    if (written - read < mLowWatermark.load(std::memory_order_relaxed) && !mSourceEnded.load(std::memory_order_relaxed))
+        mLowWatermark.store(quint32(written - read), std::memory_order_relaxed);
+    const auto offset = quint32(read % mCapacity);
+    const auto first = std::min(length, mCapacity - offset);
+
+    std::memcpy(samples, &mRing[2 * size_t(offset)], first * SAMPLE_SIZE_BYTES);
+    std::memcpy(samples + 2 * size_t(first), mRing.data(), (length - first) * SAMPLE_SIZE_BYTES);
+
+    mRead.store(read + length, std::memory_order_release);
+    mSpaceAvailable.notify_one();
+
+    return length;
+}
+
+bool TxFeed::finished() const
+{
+    return mSourceEnded.load() && available() == 0;
+}
+
+bool TxFeed::sourceEnded() const
+{
+    return mSourceEnded.load();
+}
+
+quint32 TxFeed::capacity() const
+{
+    return mCapacity;
+}
+
+quint32 TxFeed::lowWatermark() const
+{
+    return std::min(mLowWatermark.load(), mCapacity);
+}
+
+quint32 TxFeed::available() const
+{
+    return quint32(mWritten.load(std::memory_order_acquire) - mRead.load(std::memory_order_acquire));
+}
+
+QString TxFeed::errorString() const
+{
+    return mSource->errorString();
+}
+
+EndOfSource TxFeed::endOfSourceFromString(const QString& value)
+{
+    if (value == "stop") return EndOfSource::Stop;
+    if (value == "pad") return EndOfSource::Pad;
+    return EndOfSource::Loop;
+}
+
+void TxFeed::process()
+{
+    while (mProcess.load())
+    {
+        const quint32 free = mCapacity - available();
+
+        if (free < MIN_PRODUCE_SAMPLES || mSourceEnded.load())
+        {
+            mFilled.notify_all();
+
+            // The consumer notifies without the lock, so the wait is bounded
+            std::unique_lock<std::mutex> lock(mMutex);
+            mSpaceAvailable.wait_for(lock, std::chrono::milliseconds(PRODUCER_WAIT_MS));
+            continue;
+        }
+
+        if (produce(free) == 0)
+        {
+            switch (mEndOfSource)
+            {
+                case EndOfSource::Stop:
+                    mSourceEnded.store(true);
+                break;
+                case EndOfSource::Loop:
+                    if (!mSource->rewind()) mSourceEnded.store(true);
+                break;
+                case EndOfSource::Pad:
+                {
+                    const quint64 written = mWritten.load(std::memory_order_relaxed);
+                    const auto offset = quint32(written % mCapacity);
+                    const auto length = std::min(free, mCapacity - offset);
+
+                    std::memset(&mRing[2 * size_t(offset)], 0, length * SAMPLE_SIZE_BYTES);
+                    mWritten.store(written + length, std::memory_order_release);
+                }
+                break;
+            }
+        }
+    }
+}
+
+quint32 TxFeed::produce(quint32 free)
+{
+    const quint64 written = mWritten.load(std::memory_order_relaxed);
+    const auto offset = quint32(written % mCapacity);
+    const auto length = std::min(free, mCapacity - offset);
+
+    // A source that ended once keeps returning 0 until rewound
+    const auto produced = mSource->read(&mRing[2 * size_t(offset)], length);
+    mWritten.store(written + produced, std::memory_order_release);
+
+    return produced;
+}
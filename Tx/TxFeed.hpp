@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QString>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TxSource;
+
+enum class EndOfSource
+{
+    Stop,
+    Loop,
+    Pad
+};
+
+// Read-ahead between a TX source and the libbladeRF callback.
+// A feed thread keeps the single-producer/single-consumer sample ring full;
+// the callback only copies out of it and never touches the source.
+class TxFeed
+{
+public:
+    /// Takes ownership of the source; capacity in samples
+    TxFeed(TxSource* source, quint32 capacity, EndOfSource endOfSource);
+    ~TxFeed();
+
+    /// Opens the source and waits for preRoll samples (0 - the whole ring)
+    bool start(quint32 preRoll = 0);
+    void stop();
+
+    /// Consumer side. Copies up to count samples, returns the number copied
+    quint32 pop(qint16* samples, quint32 count);
+    /// The source is exhausted and everything was consumed
+    bool finished() const;
+    bool sourceEnded() const;
+    quint32 available() const;
+    quint32 capacity() const;
+    /// Smallest fill seen by the consumer before the source ended
+    quint32 lowWatermark() const;
+
+    QString errorString() const;
+
+    static EndOfSource endOfSourceFromString(const QString& value);
+
+private:
+    void process();
+    quint32 produce(quint32 free);
+
+private:
+    TxSource* const mSource;
+    const quint32 mCapacity;
+    const EndOfSource mEndOfSource;
+
+    std::vector<qint16> mRing;
+    std::atomic<quint64> mWritten;
+    std::atomic<quint64> mRead;
+    std::atomic_bool mSourceEnded;
+    std::atomic<quint32> mLowWatermark;
+    std::atomic_bool mProcess;
+
+    std::thread* mThread = nullptr;
+    std::mutex mMutex;
+    std::condition_variable mSpaceAvailable;
+    std::condition_variable mFilled;
+};
@@ -0,0 +1,144 @@
+#include <cstring>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "Processing/SampleConversion.hpp"
+#include "Processing/SignalStats.hpp"
+#include "Types/RawData.hpp"
+
+#include "TxFileSource.hpp"
+
+#define READ_AHEAD_BYTES        (32ull * 1024 * 1024)
+#define RELEASE_STEP_BYTES      (64ull * 1024 * 1024)
+
+TxFileSource::TxFileSource(const QString& path, SampleFormat format, bool normalize, float scale)
+    : mFile(path),
+      mFormat(format),
+      mSampleBytes(format == SampleFormat::Cf32 ? 2 * sizeof(float) : SAMPLE_SIZE_BYTES),
+      mNormalize(normalize),
+      mScale(scale)
+{
+
+}
+
+TxFileSource::~TxFileSource()
+{
+    if (mData) mFile.unmap(reinterpret_cast<uchar*>(const_cast<char*>(mData)));
+}
+
+bool TxFileSource::open()
+{
+    if (!mFile.open(QIODevice::ReadOnly)) return false;
+
+    mSize = quint64(mFile.size()) / mSampleBytes * mSampleBytes;
+    if (mSize == 0)
+    {
+        mError = "file holds no samples";
+        return false;
+    }
+
+    mData = reinterpret_cast<const char*>(mFile.map(0, qint64(mSize)));
+    if (!mData) return false;
+
+    advise(0, mSize, MADV_SEQUENTIAL);
+
+    if (mFormat == SampleFormat::Cf32)
+    {
+        const float peak = mNormalize ? filePeak() : 1.f;
+        if (peak == 0.f)
+        {
+            mError = "file holds only zeros, nothing to normalize";
+            return false;
+        }
+
+        qInfo("TX cf32 file peak %.4f, scaled by %.4f", peak, mScale / peak);
+        mScale = SC16_Q11_MAX * mScale / peak;
+    }
+
+    return rewind();
+}
+
+quint32 TxFileSource::read(qint16* samples, quint32 count)
+{
+    const quint64 length = std::min<quint64>(quint64(count) * mSampleBytes, mSize - mPosition);
+
+    if (mPosition + length > mAdvised)
+    {
+        const quint64 to = std::min<quint64>(mSize, mPosition + length + READ_AHEAD_BYTES);
+        advise(mAdvised, to, MADV_WILLNEED);
+        mAdvised = to;
+    }
+
+    if (mFormat == SampleFormat::Cf32)
+        SampleConversion::cf32ToSc16(reinterpret_cast<const float*>(mData + mPosition),
+                                     samples, quint32(length / mSampleBytes), mScale);
+    else
+        std::memcpy(samples, mData + mPosition, length);
+    mPosition += length;
+
+    if (mPosition - mReleased >= RELEASE_STEP_BYTES)
+    {
+        advise(mReleased, mPosition, MADV_DONTNEED);
+        mReleased = mPosition;
+    }
+
+    return quint32(length / mSampleBytes);
+}
+
+bool TxFileSource::rewind()
+{
+    if (!mData) return false;
+
+    if (mPosition > mReleased) advise(mReleased, mPosition, MADV_DONTNEED);
+    mPosition = mReleased = mAdvised = 0;
+    return true;
+}
+
+void TxFileSource::prefetch()
+{
+    if (!mData || mAdvised > mPosition) return;
+
+    mAdvised = std::min<quint64>(mSize, mPosition + READ_AHEAD_BYTES);
+    advise(mPosition, mAdvised, MADV_WILLNEED);
+}
+
+SampleFormat TxFileSource::formatFromString(const QString& format)
+{
+    return format == "cf32" ? SampleFormat::Cf32 : SampleFormat::Sc16;
+}
+
+QString TxFileSource::errorString() const
+{
+    return mFile.fileName() + ": " + (mError.isEmpty() ? mFile.errorString() : mError);
+}
+
+void TxFileSource::advise(quint64 from, quint64 to, int advice)
+{
+    static const quint64 pageSize = quint64(sysconf(_SC_PAGESIZE));
+
+    // The mapping starts at offset 0, so it is page aligned
+    from = from / pageSize * pageSize;
+    if (advice == MADV_DONTNEED) to = to / pageSize * pageSize;
+    if (to <= from) return;
+
+    madvise(const_cast<char*>(mData) + from, to - from, advice);
+}
+
+float TxFileSource::filePeak()
+{
+    // Sequential pre-pass over the whole file, pages are dropped behind it
+    const quint64 chunk = RELEASE_STEP_BYTES;
+    float peak = 0.f;
+
+    for (quint64 offset = 0; offset < mSize; offset += chunk)
+    {
+        const quint64 length = std::min<quint64>(chunk, mSize - offset);
+
+        advise(offset, std::min<quint64>(mSize, offset + length + READ_AHEAD_BYTES), MADV_WILLNEED);
+        peak = std::max(peak, SignalStats::peak(reinterpret_cast<const float*>(mData + offset), length / sizeof(float)));
+        advise(offset, offset + length, MADV_DONTNEED);
+    }
+
+    return peak;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QFile>
+
+#include "TxSource.hpp"
+
+enum class SampleFormat
+{
+    Sc16,       // raw SC16_Q11
+    Cf32        // interleaved float I/Q, +-1.0 full scale
+};
+
+// Sample file mapped into memory and read sequentially.
+// Pages already transmitted are released, so files larger than RAM play
+// with a flat resident size. cf32 is converted here, on the feed thread.
+class TxFileSource : public TxSource
+{
+public:
+    /// normalize scales the file peak to full scale, scale applies on top
+    explicit TxFileSource(const QString& path, SampleFormat format = SampleFormat::Sc16,
+                          bool normalize = false, float scale = 1.f);
+    ~TxFileSource();
+
+    bool open() override;
+    quint32 read(qint16* samples, quint32 count) override;
+    bool rewind() override;
+
+    /// Starts reading the head of the file in, so the first read does not stall
+    void prefetch();
+
+    static SampleFormat formatFromString(const QString& format);
+
+    QString errorString() const override;
+
+private:
+    void advise(quint64 from, quint64 to, int advice);
+    float filePeak();
+
+private:
+    QFile mFile;
+    QString mError;
+    const SampleFormat mFormat;
+    const quint32 mSampleBytes;
+    const bool mNormalize;
+    float mScale;
+    const char* mData = nullptr;
+    quint64 mSize = 0;
+    quint64 mPosition = 0;
+    quint64 mAdvised = 0;           // read-ahead requested up to
+    quint64 mReleased = 0;          // pages dropped up to
+};
@@ -0,0 +1,134 @@
+#include <cmath>
+
+#include "Processing/SampleConversion.hpp"
+#include "Processing/SignalStats.hpp"
+#include "Types/SessionStatistics.hpp"
+
+#include "TxGainSource.hpp"
+
+#define BLOCK_SAMPLES           4096        // scaled and measured while in cache
+#define SILENCE_DBFS            -100.0      // reported for an all-zero signal
+#define MAX_GAIN_CHANGES        1024
+
+TxGainSource::TxGainSource(TxSource* source, double gainDb, quint64 window)
+    : mSource(source),
+      mGainDb(gainDb),
+      mGain(gainQ15(gainDb)),
+      mWindow(std::max<quint64>(window, 1)),
+      mAppliedGain(mGain),
+      mAppliedDb(gainDb),
+      mMinDb(gainDb),
+      mMaxDb(gainDb)
+{
+    mChanges.reserve(MAX_GAIN_CHANGES);
+
+}
+
+TxGainSource::~TxGainSource()
+{
+    delete mSource;
+}
+
+bool TxGainSource::open()
+{
+    if (mGainDb != 0) qInfo("TX digital gain %+.1f dB", mGainDb.load());
+    return mSource->open();
+}
+
+quint32 TxGainSource::read(qint16* samples, quint32 count)
+{
+    return mSource->read(samples, count);
+}
+
+void TxGainSource::apply(qint16* samples, quint32 length)
+{
+    const auto gain = mGain.load(std::memory_order_relaxed);
+
+    // A live change is recorded where it reaches the samples
+    if (gain != mAppliedGain)
+    {
+        const double gainDb = mGainDb;
+
+        mAppliedGain = gain;
+        mAppliedDb = gainDb;
+        mMinDb = std::min(mMinDb, gainDb);
+        mMaxDb = std::max(mMaxDb, gainDb);
+        if (mChanges.size() < MAX_GAIN_CHANGES)
+            mChanges.append({ mTotal.samples + mCurrent.samples, gainDb });
+    }
+
+    for (quint32 offset = 0; offset < length; offset += BLOCK_SAMPLES)
+    {
+        const auto block = samples + 2 * size_t(offset);
+        const auto blockLength = std::min<quint32>(BLOCK_SAMPLES, length - offset);
+
+        mCurrent.clipped += SampleConversion::scaleSc16(block, 2 * blockLength, gain);
+        SignalStats::power(block, blockLength, mCurrent.powerSum, mCurrent.peakPower);
+        mCurrent.samples += blockLength;
+
+        if (mCurrent.samples >= mWindow) report();
+    }
+}
+
+bool TxGainSource::rewind()
+{
+    return mSource->rewind();
+}
+
+QString TxGainSource::errorString() const
+{
+    return mSource->errorString();
+}
+
+void TxGainSource::setGainDb(double gainDb)
+{
+    mGainDb = gainDb;
+    mGain.store(gainQ15(gainDb), std::memory_order_relaxed);
+    qInfo("TX digital gain changed to %+.1f dB", gainDb);
+}
+
+void TxGainSource::fill(SessionStatistics& statistics)
+{
+    if (mCurrent.samples) report();
+
+    statistics.gainDb = mAppliedDb;
+    statistics.gainMinDb = mMinDb;
+    statistics.gainMaxDb = mMaxDb;
+    statistics.gainChanges = mChanges;
+    statistics.clippedValues = mTotal.clipped;
+    statistics.peakDbfs = peakDbfs(mTotal);
+    statistics.crestFactorDb = crestFactorDb(mTotal);
+}
+
+void TxGainSource::report()
+{
+    if (mCurrent.clipped)
+        qWarning("TX clipping: %llu values, peak %.1f dBFS, crest factor %.1f dB",
+                 mCurrent.clipped, peakDbfs(mCurrent), crestFactorDb(mCurrent));
+    else
+        qDebug("TX level: peak %.1f dBFS, crest factor %.1f dB",
+               peakDbfs(mCurrent), crestFactorDb(mCurrent));
+
+    mTotal.samples += mCurrent.samples;
+    mTotal.clipped += mCurrent.clipped;
+    mTotal.powerSum += mCurrent.powerSum;
+    mTotal.peakPower = std::max(mTotal.peakPower, mCurrent.peakPower);
+    mCurrent = Level();
+}
+
+double TxGainSource::peakDbfs(const Level& level)
+{
+    if (level.peakPower == 0) return SILENCE_DBFS;
+    return 10 * std::log10(level.peakPower / double(SC16_Q11_MAX * SC16_Q11_MAX));
+}
+
+double TxGainSource::crestFactorDb(const Level& level)
+{
+    if (level.powerSum == 0) return 0;
+    return 10 * std::log10(level.peakPower * double(level.samples) / level.powerSum);
+}
+
+qint32 TxGainSource::gainQ15(double gainDb)
+{
+    return qint32(std::lround(32768.0 * std::pow(10.0, gainDb / 20)));
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QVector>
+
+#include <atomic>
+
+#include "Types/SessionStatistics.hpp"
+
+#include "TxSource.hpp"
+
+// Digital gain stage of a TX source.
+// Reading passes the source through, the stream applies the gain with apply()
+// as it takes samples out of the read-ahead, so a gain change is on air after
+// the transfers in flight rather than after the whole read-ahead.
+// Samples are scaled in place with saturation to the DAC range; clipping and
+// the signal level are measured on what is actually sent. The level is reported
+// once per window, with a warning for every window that clipped.
+class TxGainSource : public TxSource
+{
+public:
+    /// Takes ownership of the source; window in samples
+    TxGainSource(TxSource* source, double gainDb, quint64 window);
+    ~TxGainSource();
+
+    bool open() override;
+    quint32 read(qint16* samples, quint32 count) override;
+    bool rewind() override;
+
+    QString errorString() const override;
+
+    /// Stream thread: scales and measures samples about to be sent
+    void apply(qint16* samples, quint32 count);
+    /// Any thread, applied from the next apply()
+    void setGainDb(double gainDb);
+
+    /// Level of the whole session, call once the feed thread is stopped
+    void fill(SessionStatistics& statistics);
+
+private:
+    struct Level
+    {
+        quint64 samples = 0;
+        quint64 clipped = 0;                // I or Q values
+        quint64 powerSum = 0;
+        quint32 peakPower = 0;
+    };
+
+    void report();
+
+    static double peakDbfs(const Level& level);
+    static double crestFactorDb(const Level& level);
+    static qint32 gainQ15(double gainDb);
+
+private:
+    TxSource* const mSource;
+    std::atomic<double> mGainDb;
+    std::atomic<qint32> mGain;              // Q15
+    const quint64 mWindow;
+
+    // Stream thread: the gain the samples were scaled with and when it changed
+    qint32 mAppliedGain;
+    double mAppliedDb;
+    double mMinDb;
+    double mMaxDb;
+    QVector<SessionStatistics::GainChange> mChanges;
+
+    Level mTotal;
+    Level mCurrent;
+};
@@ -0,0 +1,156 @@
+#include <QDir>
+
+#include <cstring>
+
+#include "Types/RawData.hpp"
+
+#include "TxPlaylistSource.hpp"
+
+TxPlaylistSource::TxPlaylistSource(const QList<PlaylistEntry>& entries, SampleFormat format,
+                                   bool normalize, float scale, bool loop)
+    : mEntries(entries),
+      mFormat(format),
+      mNormalize(normalize),
+      mScale(scale),
+      mLoop(loop)
+{
+
+}
+
+TxPlaylistSource::~TxPlaylistSource()
+{
+    release();
+}
+
+bool TxPlaylistSource::open()
+{
+    if (mEntries.isEmpty())
+    {
+        mError = "playlist is empty";
+        return false;
+    }
+
+    mSource = createSource(0);
+    if (!mSource->open())
+    {
+        mError = mSource->errorString();
+        delete mSource;
+        mSource = nullptr;
+        return false;
+    }
+
+    mIndex = 0;
+    mPlays = 0;
+    mGapLeft = 0;
+    prefetch(nextIndex(0));
+
+    qInfo("TX playlist: %d files", mEntries.size());
+    return true;
+}
+
+quint32 TxPlaylistSource::read(qint16* samples, quint32 count)
+{
+    quint32 done = 0;
+
+    while (done < count)
+    {
+        if (mGapLeft)
+        {
+            const auto length = quint32(std::min<quint64>(mGapLeft, count - done));
+            std::memset(samples + 2 * size_t(done), 0, length * SAMPLE_SIZE_BYTES);
+            mGapLeft -= length;
+            done += length;
+            continue;
+        }
+
+        if (!mSource) break;
+
+        const auto length = mSource->read(samples + 2 * size_t(done), count - done);
+        if (length == 0)
+        {
+            mGapLeft = mEntries[mIndex].gap;
+            advance();
+        }
+        done += length;
+    }
+
+    return done;
+}
+
+bool TxPlaylistSource::rewind()
+{
+    release();
+    return open();
+}
+
+QString TxPlaylistSource::errorString() const
+{
+    return mError;
+}
+
+TxFileSource* TxPlaylistSource::createSource(int index) const
+{
+    return new TxFileSource(QDir::current().absoluteFilePath(mEntries[index].fileName),
+                            mFormat, mNormalize, mScale);
+}
+
+int TxPlaylistSource::nextIndex(int index) const
+{
+    if (index + 1 < mEntries.size()) return index + 1;
+    return mLoop ? 0 : -1;
+}
+
+void TxPlaylistSource::prefetch(int index)
+{
+    mNextIndex = index;
+    if (index < 0 || index == mIndex) return;
+
+    // Mapping, a cf32 peak pre-pass and the read-ahead all happen off the feed thread
+    mNext = std::async(std::launch::async, [this, index]() {
+        auto source = createSource(index);
+        if (!source->open())
+        {
+            qWarning("Can't open playlist file: %s", qPrintable(source->errorString()));
+            delete source;
+            return static_cast<TxFileSource*>(nullptr);
+        }
+        source->prefetch();
+        return source;
+    });
+}
+
+void TxPlaylistSource::advance()
+{
+    if (++mPlays < mEntries[mIndex].repeat || mNextIndex == mIndex)
+    {
+        if (mPlays >= mEntries[mIndex].repeat) mPlays = 0;
+        mSource->rewind();
+        mSource->prefetch();
+        return;
+    }
+
+    delete mSource;
+    mSource = nullptr;
+    mPlays = 0;
+
+    if (mNextIndex < 0) return;
+
+    mSource = mNext.get();
+    if (!mSource)
+    {
+        mError = "playlist file " + mEntries[mNextIndex].fileName + " can't be opened";
+        return;
+    }
+
+    mIndex = mNextIndex;
+    prefetch(nextIndex(mIndex));
+}
+
+void TxPlaylistSource::release()
+{
+    if (mNext.valid()) delete mNext.get();
+
+    delete mSource;
+    mSource = nullptr;
+    mNextIndex = -1;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QList>
+
+#include <future>
+
+#include "Types/PlaylistEntry.hpp"
+
+#include "TxFileSource.hpp"
+
+// Files played back to back without a sample of gap between them, besides
+// the configured ones. The next file is opened and read in on a worker thread
+// while the current one drains, so switching costs nothing on the feed thread.
+class TxPlaylistSource : public TxSource
+{
+public:
+    /// loop plays the list endlessly, the first file is prefetched after the last one
+    TxPlaylistSource(const QList<PlaylistEntry>& entries, SampleFormat format,
+                     bool normalize, float scale, bool loop);
+    ~TxPlaylistSource();
+
+    bool open() override;
+    quint32 read(qint16* samples, quint32 count) override;
+    bool rewind() override;
+
+    QString errorString() const override;
+
+private:
+    TxFileSource* createSource(int index) const;
+    int nextIndex(int index) const;
+    void prefetch(int index);
+    void advance();
+    void release();
+
+private:
+    const QList<PlaylistEntry> mEntries;
+    const SampleFormat mFormat;
+    const bool mNormalize;
+    const float mScale;
+    const bool mLoop;
+
+    TxFileSource* mSource = nullptr;    // nullptr - the playlist ended
+    int mIndex = 0;
+    unsigned mPlays = 0;                // completed repeats of the current entry
+    quint64 mGapLeft = 0;
+
+    std::future<TxFileSource*> mNext;
+    int mNextIndex = -1;
+    QString mError;
+};
@@ -0,0 +1,70 @@
+#include <algorithm>
+
+#include "TxResampleSource.hpp"
+
+#define INPUT_BLOCK_SAMPLES     4096
+
+TxResampleSource::TxResampleSource(TxSource* source, quint64 sourceRate, quint64 sampleRate, bool flush)
+    : mSource(source),
+      mSourceRate(sourceRate),
+      mSampleRate(sampleRate),
+      mResampler(sourceRate, sampleRate),
+      mInput(2 * INPUT_BLOCK_SAMPLES),
+      mFlush(flush)
+{
+
+}
+
+TxResampleSource::~TxResampleSource()
+{
+    delete mSource;
+}
+
+bool TxResampleSource::open()
+{
+    if (!mResampler.valid())
+    {
+        mError = QString("can't resample %1 to %2 S/s, the ratio needs too many phases")
+                     .arg(mSourceRate).arg(mSampleRate);
+        return false;
+    }
+
+    qInfo("TX resampling %llu to %llu S/s (%u/%u)",
+          mSourceRate, mSampleRate, mResampler.interpolation(), mResampler.decimation());
+    return mSource->open();
+}
+
+quint32 TxResampleSource::read(qint16* samples, quint32 count)
+{
+    quint32 produced = mResampler.pull(samples, count);
+
+    while (produced < count)
+    {
+        auto length = mSource->read(mInput.data(), INPUT_BLOCK_SAMPLES);
+        if (length == 0)
+        {
+            if (!mFlush || mFlushed) break;
+
+            // The last input samples are still inside the filter delay
+            length = std::min<quint32>(mResampler.tapCount() / 2 + 1, INPUT_BLOCK_SAMPLES);
+            std::fill(mInput.begin(), mInput.begin() + 2 * size_t(length), 0);
+            mFlushed = true;
+        }
+
+        mResampler.push(mInput.data(), length);
+        produced += mResampler.pull(samples + 2 * size_t(produced), count - produced);
+    }
+
+    return produced;
+}
+
+bool TxResampleSource::rewind()
+{
+    mFlushed = false;
+    return mSource->rewind();
+}
+
+QString TxResampleSource::errorString() const
+{
+    return mError.isEmpty() ? mSource->errorString() : mError;
+}
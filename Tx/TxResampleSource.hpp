@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+
+#include "Processing/PolyphaseResampler.hpp"
+
+#include "TxSource.hpp"
+
+// Plays a source recorded at another sample rate, see PolyphaseResampler.
+// The filter history is kept over rewinds, so looped files stay continuous.
+// A source that is not looped is followed by zeros once it ends, flushing
+// the samples still held by the filter delay.
+class TxResampleSource : public TxSource
+{
+public:
+    /// Takes ownership of the source
+    TxResampleSource(TxSource* source, quint64 sourceRate, quint64 sampleRate, bool flush);
+    ~TxResampleSource();
+
+    bool open() override;
+    quint32 read(qint16* samples, quint32 count) override;
+    bool rewind() override;
+
+    QString errorString() const override;
+
+private:
+    TxSource* const mSource;
+    const quint64 mSourceRate;
+    const quint64 mSampleRate;
+    PolyphaseResampler mResampler;
+    std::vector<qint16> mInput;
+    const bool mFlush;
+    bool mFlushed = false;
+    QString mError;
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <QString>
+
+// Producer of SC16_Q11 samples for the TX feed. Runs on the feed thread,
+// never on the libbladeRF callback thread.
+class TxSource
+{
+public:
+    virtual ~TxSource() = default;
+
+    virtual bool open() = 0;
+    /// Reads up to count samples (I/Q pairs), 0 - end of the source
+    virtual quint32 read(qint16* samples, quint32 count) = 0;
+    /// Restarts the source from the beginning, false if not supported
+    virtual bool rewind() = 0;
+
+    virtual QString errorString() const { return QString(); }
+};
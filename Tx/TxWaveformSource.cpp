@@ -0,0 +1,30 @@
+#include "TxWaveformSource.hpp"
+
+TxWaveformSource::TxWaveformSource(const WaveformConfig& config, double sampleRate)
+    : mConfig(config),
+      mGenerator(config, sampleRate)
+{
+
+}
+
+bool TxWaveformSource::open()
+{
+    return mConfig.valid();
+}
+
+quint32 TxWaveformSource::read(qint16* samples, quint32 count)
+{
+    mGenerator.generate(samples, count);
+    return count;
+}
+
+bool TxWaveformSource::rewind()
+{
+    mGenerator.reset();
+    return true;
+}
+
+QString TxWaveformSource::errorString() const
+{
+    return "invalid " + mConfig.type + " waveform parameters";
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Processing/WaveformGenerator.hpp"
+
+#include "TxSource.hpp"
+
+// Endless built-in waveform, see WaveformConfig
+class TxWaveformSource : public TxSource
+{
+public:
+    TxWaveformSource(const WaveformConfig& config, double sampleRate);
+
+    bool open() override;
+    quint32 read(qint16* samples, quint32 count) override;
+    bool rewind() override;
+
+    QString errorString() const override;
+
+private:
+    const WaveformConfig mConfig;
+    WaveformGenerator mGenerator;
+};
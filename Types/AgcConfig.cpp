@@ -0,0 +1,31 @@
+#include "AgcConfig.hpp"
+
+DefineJsonField(enabled)
+DefineJsonField(target)
+DefineJsonField(hysteresis)
+DefineJsonField(max_step)
+DefineJsonField(interval)
+DefineJsonField(min_gain)
+DefineJsonField(max_gain)
+
+void AgcConfig::fromJson(const QJsonObject& json)
+{
+    enabled = json[i_enabled].toBool();
+    target = json[i_target].toDouble(-12);
+    hysteresis = json[i_hysteresis].toDouble(3);
+    maxStep = json[i_max_step].toInt(6);
+    interval = json[i_interval].toDouble(0.1);
+    minGain = json[i_min_gain].toInt(0);
+    maxGain = json[i_max_gain].toInt(60);
+}
+
+void AgcConfig::fillJson(QJsonObject& json) const
+{
+    json[i_enabled] = enabled;
+    json[i_target] = target;
+    json[i_hysteresis] = hysteresis;
+    json[i_max_step] = maxStep;
+    json[i_interval] = interval;
+    json[i_min_gain] = minGain;
+    json[i_max_gain] = maxGain;
+}
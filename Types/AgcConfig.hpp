@@ -0,0 +1,34 @@
+#pragma once
+
+#include "JsonConfig.hpp"
+
+// Software RX gain control. Every interval the peak level of each channel is
+// compared with the target; outside the hysteresis band the gain of that
+// channel moves towards it by at most maxStep dB. A clipping channel always
+// steps down by maxStep.
+class AgcConfig : public JsonConfig
+{
+public:
+    ~AgcConfig() = default;
+
+    virtual bool valid() const override
+    {
+        return target < 0
+            && hysteresis >= 0
+            && maxStep > 0
+            && interval > 0
+            && minGain <= maxGain;
+    }
+
+    virtual void fromJson(const QJsonObject& json) override;
+    virtual void fillJson(QJsonObject& json) const override;
+
+public:
+    bool enabled = false;
+    double target = -12;                // peak dBFS
+    double hysteresis = 3;              // dB around the target left alone
+    int maxStep = 6;                    // dB per adjustment
+    double interval = 0.1;              // seconds measured per adjustment
+    int minGain = 0;
+    int maxGain = 60;
+};
@@ -0,0 +1,25 @@
+#include "BurstConfig.hpp"
+
+DefineJsonField(file_name)
+DefineJsonField(timestamp)
+DefineJsonField(relative)
+DefineJsonField(repeat)
+DefineJsonField(period)
+
+void BurstConfig::fromJson(const QJsonObject& json)
+{
+    fileName = json[i_file_name].toString();
+    timestamp = json[i_timestamp].toString().toULongLong();
+    relative = json[i_relative].toBool(true);
+    repeat = json[i_repeat].toInt(1);
+    period = json[i_period].toString().toULongLong();
+}
+
+void BurstConfig::fillJson(QJsonObject& json) const
+{
+    json[i_file_name] = fileName;
+    json[i_timestamp] = QString::number(timestamp);
+    json[i_relative] = relative;
+    json[i_repeat] = int(repeat);
+    json[i_period] = QString::number(period);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "JsonConfig.hpp"
+
+// One scheduled TX burst of a mission.
+// The timestamp is in device samples; a relative one counts from the start
+// of the previous burst (from the session start for the first one).
+class BurstConfig : public JsonConfig
+{
+public:
+    ~BurstConfig() = default;
+
+    virtual bool valid() const override
+    {
+        return !fileName.isEmpty()
+            && repeat != 0
+            && (repeat == 1 || period != 0);
+    };
+
+    virtual void fromJson(const QJsonObject& json) override;
+    virtual void fillJson(QJsonObject& json) const override;
+
+public:
+    QString fileName;
+    unsigned long long timestamp = 0;
+    bool relative = true;
+    unsigned repeat = 1;
+    unsigned long long period = 0;      // samples between repeats
+};
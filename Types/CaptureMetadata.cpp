@@ -0,0 +1,140 @@
+#include <QJsonArray>
+
+#include "CaptureMetadata.hpp"
+
+DefineJsonField(samplerate)
+DefineJsonField(frequency)
+DefineJsonField(samples_per_buffer)
+DefineJsonField(duplex)
+DefineJsonField(overload_policy)
+DefineJsonField(writer_queue)
+DefineJsonField(queue_high_watermark)
+DefineJsonField(buffers_written)
+DefineJsonField(buffers_dropped)
+DefineJsonField(buffers_spilled)
+DefineJsonField(dropped_ranges)
+DefineJsonField(segments)
+DefineJsonField(first_buffer)
+DefineJsonField(sample_offset)
+DefineJsonField(samples)
+DefineJsonField(duty_on)
+DefineJsonField(duty_off)
+DefineJsonField(windows)
+DefineJsonField(stream_offset)
+DefineJsonField(timestamp)
+DefineJsonField(parts)
+DefineJsonField(rx1)
+DefineJsonField(rx2)
+
+void CaptureMetadata::fromJson(const QJsonObject& json)
+{
+    sampleRate = json[i_samplerate].toString().toULongLong();
+    frequency = json[i_frequency].toString().toULongLong();
+    samplesPerBuffer = json[i_samples_per_buffer].toInt();
+    duplex = json[i_duplex].toBool();
+    overloadPolicy = json[i_overload_policy].toString();
+    writerQueue = json[i_writer_queue].toInt();
+    queueHighWatermark = json[i_queue_high_watermark].toInt();
+    buffersWritten = json[i_buffers_written].toString().toULongLong();
+    buffersDropped = json[i_buffers_dropped].toString().toULongLong();
+    buffersSpilled = json[i_buffers_spilled].toString().toULongLong();
+
+    droppedRanges.clear();
+    for (const auto& range : json[i_dropped_ranges].toArray())
+    {
+        const auto bounds = range.toArray();
+        droppedRanges.append(qMakePair(quint32(bounds.at(0).toDouble()), quint32(bounds.at(1).toDouble())));
+    }
+
+    segments.clear();
+    for (const auto& value : json[i_segments].toArray())
+    {
+        const auto segment = value.toObject();
+        segments.append({ segment[i_frequency].toString().toULongLong(),
+                          unsigned(segment[i_first_buffer].toDouble()),
+                          segment[i_sample_offset].toString().toULongLong(),
+                          segment[i_samples].toString().toULongLong() });
+    }
+
+    dutyOn = json[i_duty_on].toString().toULongLong();
+    dutyOff = json[i_duty_off].toString().toULongLong();
+
+    windows.clear();
+    for (const auto& value : json[i_windows].toArray())
+    {
+        const auto window = value.toObject();
+        windows.append({ window[i_stream_offset].toString().toULongLong(),
+                         window[i_timestamp].toString().toULongLong(),
+                         window[i_sample_offset].toString().toULongLong(),
+                         window[i_samples].toString().toULongLong() });
+    }
+
+    parts.clear();
+    for (const auto& value : json[i_parts].toArray())
+    {
+        const auto part = value.toObject();
+        parts.append({ part[i_rx1].toString(),
+                       part[i_rx2].toString(),
+                       part[i_sample_offset].toString().toULongLong() });
+    }
+}
+
+void CaptureMetadata::fillJson(QJsonObject& json) const
+{
+    QJsonArray ranges;
+    for (const auto& range : droppedRanges)
+        ranges.append(QJsonArray { qint64(range.first), qint64(range.second) });
+
+    QJsonArray segmentArray;
+    for (const auto& segment : segments)
+    {
+        QJsonObject value;
+        value[i_frequency] = QString::number(segment.frequency);
+        value[i_first_buffer] = qint64(segment.firstBuffer);
+        value[i_sample_offset] = QString::number(segment.sampleOffset);
+        value[i_samples] = QString::number(segment.samples);
+        segmentArray.append(value);
+    }
+
+    QJsonArray windowArray;
+    for (const auto& window : windows)
+    {
+        QJsonObject value;
+        value[i_stream_offset] = QString::number(window.streamOffset);
+        if (window.timestamp) value[i_timestamp] = QString::number(window.timestamp);
+        value[i_sample_offset] = QString::number(window.sampleOffset);
+        value[i_samples] = QString::number(window.samples);
+        windowArray.append(value);
+    }
+
+    QJsonArray partArray;
+    for (const auto& part : parts)
+    {
+        QJsonObject value;
+        value[i_rx1] = part.rx1;
+        value[i_rx2] = part.rx2;
+        value[i_sample_offset] = QString::number(part.sampleOffset);
+        partArray.append(value);
+    }
+
+    json[i_samplerate] = QString::number(sampleRate);
+    json[i_frequency] = QString::number(frequency);
+    json[i_samples_per_buffer] = int(samplesPerBuffer);
+    json[i_duplex] = duplex;
+    json[i_overload_policy] = overloadPolicy;
+    json[i_writer_queue] = int(writerQueue);
+    json[i_queue_high_watermark] = int(queueHighWatermark);
+    json[i_buffers_written] = QString::number(buffersWritten);
+    json[i_buffers_dropped] = QString::number(buffersDropped);
+    json[i_buffers_spilled] = QString::number(buffersSpilled);
+    json[i_dropped_ranges] = ranges;
+    json[i_segments] = segmentArray;
+    json[i_parts] = partArray;
+
+    if (dutyOn)
+    {
+        json[i_duty_on] = QString::number(dutyOn);
+        json[i_duty_off] = QString::number(dutyOff);
+        json[i_windows] = windowArray;
+    }
+}
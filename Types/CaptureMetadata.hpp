@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QList>
+#include <QPair>
+
+#include "JsonConfig.hpp"
+
+// Sidecar describing how a capture was recorded, written next to the rx files
+class CaptureMetadata : public JsonConfig
+{
+public:
+    struct Segment
+    {
+        unsigned long long frequency;
+        unsigned firstBuffer;               // buffer index of the first sample
+        unsigned long long sampleOffset;    // in the rx parts taken as one file
+        unsigned long long samples;
+    };
+
+    struct Window
+    {
+        unsigned long long streamOffset;    // stream sample of the first sample
+        unsigned long long timestamp;       // device timestamp of the first sample, 0 - not known
+        unsigned long long sampleOffset;    // in the rx parts taken as one file
+        unsigned long long samples;
+    };
+
+    struct Part
+    {
+        QString rx1;
+        QString rx2;
+        unsigned long long sampleOffset;    // of the first sample of the part
+    };
+
+    ~CaptureMetadata() = default;
+
+    virtual void fromJson(const QJsonObject& json) override;
+    virtual void fillJson(QJsonObject& json) const override;
+
+public:
+    unsigned long long sampleRate = 0;
+    unsigned long long frequency = 0;
+    unsigned samplesPerBuffer = 0;
+    bool duplex = false;                // rx sample 0 is aligned with tx sample 0
+
+    QString overloadPolicy;
+    unsigned writerQueue = 0;
+    unsigned queueHighWatermark = 0;
+    unsigned long long buffersWritten = 0;
+    unsigned long long buffersDropped = 0;
+    unsigned long long buffersSpilled = 0;
+    QList<QPair<quint32, quint32>> droppedRanges;
+    QList<Segment> segments;                // scan dwells and live retunes, in file order
+    unsigned long long dutyOn = 0;          // samples
+    unsigned long long dutyOff = 0;         // samples
+    QList<Window> windows;                  // recorded duty-cycle windows, in file order
+    QList<Part> parts;                      // rx files in recording order, rotation starts a new one
+};
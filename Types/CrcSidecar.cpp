@@ -0,0 +1,67 @@
+#include <algorithm>
+
+#include "Processing/Crc32c.hpp"
+
+#include "CrcSidecar.hpp"
+
+CrcSidecar::CrcSidecar(const QString& dataPath, quint32 blockSize)
+    : mFile(path(dataPath)),
+      mBlockSize(blockSize)
+{
+
+}
+
+CrcSidecar::~CrcSidecar()
+{
+    close();
+}
+
+QString CrcSidecar::path(const QString& dataPath)
+{
+    return dataPath + ".crc";
+}
+
+bool CrcSidecar::open()
+{
+    const quint32 header[] = { MAGIC, mBlockSize };
+
+    if (mBlockSize == 0 || !mFile.open(QIODevice::WriteOnly)) return false;
+    return mFile.write(reinterpret_cast<const char*>(header), HEADER_SIZE) == HEADER_SIZE;
+}
+
+void CrcSidecar::update(const char* data, qint64 size)
+{
+    while (size > 0)
+    {
+        const quint32 length = quint32(std::min<qint64>(size, mBlockSize - mFilled));
+
+        mCrc = Crc32c::update(mCrc, data, length);
+        mFilled += length;
+        data += length;
+        size -= length;
+
+        if (mFilled == mBlockSize)
+        {
+            mFile.write(reinterpret_cast<const char*>(&mCrc), sizeof(mCrc));
+            mFilled = 0;
+            mCrc = 0;
+        }
+    }
+}
+
+void CrcSidecar::close()
+{
+    if (!mFile.isOpen()) return;
+
+    if (mFilled)
+        mFile.write(reinterpret_cast<const char*>(&mCrc), sizeof(mCrc));
+
+    mFilled = 0;
+    mCrc = 0;
+    mFile.close();
+}
+
+QString CrcSidecar::errorString() const
+{
+    return mFile.errorString();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QFile>
+
+// Integrity records of a capture file, stored next to it as <file>.crc
+//
+// | magic(4) | block size(4) | crc32c of block 0(4) | ... | crc32c of the last block(4) |
+//
+// The last block may be shorter than the block size.
+class CrcSidecar
+{
+public:
+    static constexpr quint32 MAGIC       = 0x31435243; // "CRC1"
+    static constexpr quint32 HEADER_SIZE = 2 * sizeof(quint32);
+
+    CrcSidecar(const QString& dataPath, quint32 blockSize);
+    ~CrcSidecar();
+
+    static QString path(const QString& dataPath);
+
+    bool open();
+    void update(const char* data, qint64 size);
+    /// Stores the checksum of the trailing partial block
+    void close();
+    QString errorString() const;
+
+private:
+    QFile mFile;
+    const quint32 mBlockSize;
+    quint32 mFilled = 0;
+    quint32 mCrc = 0;
+};
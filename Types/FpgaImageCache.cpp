@@ -0,0 +1,74 @@
+#include <QJsonDocument>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QFile>
+#include <QDir>
+
+#include "FpgaImageCache.hpp"
+#include "JsonConfig.hpp"
+
+DefineJsonField(image)
+DefineJsonField(size)
+DefineJsonField(modified)
+
+FpgaImageCache::FpgaImageCache(const QString& path)
+    : mPath(path)
+{
+    QFile file(mPath);
+    if (file.open(QIODevice::ReadOnly))
+        mEntries = QJsonDocument::fromJson(file.readAll()).object();
+}
+
+QString FpgaImageCache::image(const QString& serial, size_t fpgaBytes) const
+{
+    const auto entry = mEntries[key(serial, fpgaBytes)].toObject();
+    const auto image = entry[i_image].toString();
+
+    if (image.isEmpty() || entry != describe(image)) return QString();
+    return image;
+}
+
+bool FpgaImageCache::changed(const QString& serial, size_t fpgaBytes) const
+{
+    const auto entry = mEntries[key(serial, fpgaBytes)].toObject();
+    const auto image = entry[i_image].toString();
+
+    return !image.isEmpty() && QFileInfo(image).exists() && entry != describe(image);
+}
+
+QString FpgaImageCache::lastImage(const QString& serial, size_t fpgaBytes) const
+{
+    return mEntries[key(serial, fpgaBytes)].toObject()[i_image].toString();
+}
+
+void FpgaImageCache::store(const QString& serial, size_t fpgaBytes, const QString& image)
+{
+    mEntries.insert(key(serial, fpgaBytes), describe(image));
+}
+
+bool FpgaImageCache::save() const
+{
+    QDir().mkpath(QFileInfo(mPath).absolutePath());
+
+    QFile file(mPath);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    return file.write(QJsonDocument(mEntries).toJson(QJsonDocument::Indented)) > 0;
+}
+
+QString FpgaImageCache::key(const QString& serial, size_t fpgaBytes)
+{
+    return serial + '/' + QString::number(fpgaBytes);
+}
+
+QJsonObject FpgaImageCache::describe(const QString& image)
+{
+    const QFileInfo info(image);
+    QJsonObject json;
+
+    json[i_image] = image;
+    json[i_size] = QString::number(info.size());
+    json[i_modified] = QString::number(info.lastModified().toMSecsSinceEpoch());
+
+    return json;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QString>
+
+// Which image of the FPGA folder fits a device, so the folder is not scanned
+// on every launch. Entries are keyed by serial and FPGA size and remember the
+// size and modification time of the image that was loaded.
+class FpgaImageCache
+{
+public:
+    explicit FpgaImageCache(const QString& path);
+
+    /// Cached image path, empty if unknown or the file changed since it was loaded
+    QString image(const QString& serial, size_t fpgaBytes) const;
+    /// The image loaded last time was replaced on disk
+    bool changed(const QString& serial, size_t fpgaBytes) const;
+    /// Path of the image loaded last time, changed or not
+    QString lastImage(const QString& serial, size_t fpgaBytes) const;
+
+    void store(const QString& serial, size_t fpgaBytes, const QString& image);
+    bool save() const;
+
+private:
+    static QString key(const QString& serial, size_t fpgaBytes);
+    static QJsonObject describe(const QString& image);
+
+private:
+    const QString mPath;
+    QJsonObject mEntries;
+};
@@ -1,3 +1,6 @@
+#include <QJsonArray>
+#include <QDir>
+
 #include "MissionConfig.hpp"
 
 DefineJsonField(samples_count)
@@ -8,7 +11,39 @@ DefineJsonField(bandwidth)
 DefineJsonField(direction)
 DefineJsonField(channel)
 DefineJsonField(tryes)
+DefineJsonField(duration)
+DefineJsonField(output_directory)
 DefineJsonField(gain)
+DefineJsonField(compression)
+DefineJsonField(compression_threads)
+DefineJsonField(event_capture)
+DefineJsonField(event_pre_roll)
+DefineJsonField(event_post_roll)
+DefineJsonField(event_level)
+DefineJsonField(writer_queue)
+DefineJsonField(overload_policy)
+DefineJsonField(spill_path)
+DefineJsonField(crc_block_size)
+DefineJsonField(shm_name)
+DefineJsonField(shm_slots)
+DefineJsonField(control_socket)
+DefineJsonField(rx_start_timestamp)
+DefineJsonField(rx_start_offset)
+DefineJsonField(duty_on)
+DefineJsonField(duty_off)
+DefineJsonField(tx_end_of_file)
+DefineJsonField(tx_read_ahead)
+DefineJsonField(tx_pre_roll)
+DefineJsonField(tx_format)
+DefineJsonField(tx_normalize)
+DefineJsonField(tx_scale)
+DefineJsonField(tx_gain_db)
+DefineJsonField(tx_source_rate)
+DefineJsonField(bursts)
+DefineJsonField(waveform)
+DefineJsonField(playlist)
+DefineJsonField(scan)
+DefineJsonField(agc)
 
 void MissionConfig::fromJson(const QJsonObject& json)
 {
@@ -19,10 +54,72 @@ void MissionConfig::fromJson(const QJsonObject& json)
     direction = Direction(json[i_direction].toInt());
     channel = Channel(json[i_channel].toInt());
     tryCount = json[i_tryes].toInt();
+    duration = json[i_duration].toDouble();
+    outputDirectory = json[i_output_directory].toString();
     gain = json[i_gain].toInt();
+    compression = json[i_compression].toBool();
+    compressionThreads = json[i_compression_threads].toInt();
+    eventCapture = json[i_event_capture].toBool();
+    eventPreRoll = json[i_event_pre_roll].toDouble();
+    eventPostRoll = json[i_event_post_roll].toDouble();
+    eventLevel = json[i_event_level].toInt();
+    writerQueue = json[i_writer_queue].toInt(256);
+    overloadPolicy = json[i_overload_policy].toString("drop_newest");
+    spillPath = json[i_spill_path].toString();
+    crcBlockSize = json[i_crc_block_size].toInt();
+    shmName = json[i_shm_name].toString();
+    shmSlots = json[i_shm_slots].toInt(64);
+    controlSocket = json[i_control_socket].toString();
+    rxStartTimestamp = json[i_rx_start_timestamp].toString().toULongLong();
+    rxStartOffset = json[i_rx_start_offset].toString().toULongLong();
+    dutyOn = json[i_duty_on].toString().toULongLong();
+    dutyOff = json[i_duty_off].toString().toULongLong();
+    txEndOfFile = json[i_tx_end_of_file].toString("loop");
+    txReadAhead = json[i_tx_read_ahead].toInt(64);
+    txPreRoll = json[i_tx_pre_roll].toInt();
+    txFormat = json[i_tx_format].toString("sc16");
+    txNormalize = json[i_tx_normalize].toBool();
+    txScale = json[i_tx_scale].toDouble(1.0);
+    txGainDb = json[i_tx_gain_db].toDouble();
+    txSourceRate = json[i_tx_source_rate].toString().toULongLong();
+
+    bursts.clear();
+    for (const auto& value : json[i_bursts].toArray())
+    {
+        BurstConfig burst;
+        burst.fromJson(value.toObject());
+        bursts.append(burst);
+    }
+
+    waveform.fromJson(json[i_waveform].toObject());
+
+    playlist.clear();
+    for (const auto& value : json[i_playlist].toArray())
+    {
+        PlaylistEntry entry;
+        entry.fromJson(value.toObject());
+        playlist.append(entry);
+    }
+
+    scan.fromJson(json[i_scan].toObject());
+    agc.fromJson(json[i_agc].toObject());
+
     fileName = json[i_file_name].toString();
 }
 
+QString MissionConfig::outputPath(const QString& name) const
+{
+    QDir directory(QDir::current());
+
+    if (!outputDirectory.isEmpty())
+    {
+        directory.mkpath(outputDirectory);
+        directory.cd(outputDirectory);
+    }
+
+    return directory.absoluteFilePath(name);
+}
+
 void MissionConfig::fillJson(QJsonObject& json) const
 {
 
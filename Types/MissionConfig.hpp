@@ -1,15 +1,27 @@
 #pragma once
 
+#include <QList>
+
+#include <algorithm>
+
+#include "AgcConfig.hpp"
+#include "BurstConfig.hpp"
 #include "JsonConfig.hpp"
+#include "PlaylistEntry.hpp"
+#include "RawData.hpp"
+#include "ScanConfig.hpp"
+#include "WaveformConfig.hpp"
 
 #define UNLIMITED 0
+#define MAX_PRE_ROLL_BYTES      (1ull << 30)    // per channel, the pre-trigger ring is held in RAM
 
 class QStringList;
 
 enum class Direction
 {
     RX = 1,
-    TX
+    TX,
+    Duplex          // RX and TX in one session on a shared trigger
 };
 
 enum class Channel
@@ -28,12 +40,30 @@ public:
         return samplesCount != 0
             && sampleRate != 0
             && frequency != 0
-            && bandwidth != 0;
+            && bandwidth != 0
+            && (overloadPolicy == "block" || overloadPolicy == "drop_newest" || overloadPolicy == "drop_oldest"
+                || (overloadPolicy == "spill" && !spillPath.isEmpty()))
+            && (rxStartTimestamp == 0 || rxStartOffset == 0)
+            && (direction != Direction::Duplex || (rxStartTimestamp == 0 && rxStartOffset == 0))
+            && (!eventCapture || (eventPreRoll >= 0 && eventPostRoll >= 0
+                                  && eventPreRoll * sampleRate * SAMPLE_SIZE_BYTES <= MAX_PRE_ROLL_BYTES))
+            && (dutyOn == 0 || (dutyOff != 0 && direction != Direction::TX && !scan.enabled() && !eventCapture))
+            && (direction != Direction::Duplex || bursts.isEmpty())
+            && (bursts.isEmpty() || txSourceRate == 0 || txSourceRate == sampleRate)  // bursts are sent as stored
+            && txGainDb >= -60.0 && txGainDb <= 24.0
+            && (!scan.enabled() || (scan.valid() && direction == Direction::RX && !eventCapture))
+            && (!agc.enabled || (agc.valid() && direction != Direction::TX))
+            && std::all_of(bursts.begin(), bursts.end(), [](const BurstConfig& burst) { return burst.valid(); })
+            && std::all_of(playlist.begin(), playlist.end(), [](const PlaylistEntry& entry) { return entry.valid(); })
+            && (!waveform.enabled() || waveform.valid());
     };
 
     virtual void fromJson(const QJsonObject& json) override;
     virtual void fillJson(QJsonObject& json) const override;
 
+    /// Absolute path of an output file, outputDirectory is created on demand
+    QString outputPath(const QString& name) const;
+
 public:
     unsigned long long samplesCount = 0;
     unsigned long long sampleRate = 0;
@@ -41,8 +71,40 @@ public:
     unsigned long long bandwidth = 0;
     Direction direction = Direction::RX;
     Channel channel = Channel::One;
-    unsigned tryCount = UNLIMITED;
+    unsigned tryCount = UNLIMITED;      // passes over the scheduled missions
+    double duration = 0;                // seconds per run, 0 - until the session stops
+    QString outputDirectory;            // relative to the working directory
     unsigned short gain = 0;
+    bool compression = false;
+    unsigned compressionThreads = 0;
+    bool eventCapture = false;
+    double eventPreRoll = 0;            // seconds
+    double eventPostRoll = 0;           // seconds
+    unsigned short eventLevel = 0;      // detector peak level, 0 - disabled
+    unsigned writerQueue = 256;         // buffers
+    QString overloadPolicy;             // block, drop_newest, drop_oldest or spill
+    QString spillPath;
+    unsigned crcBlockSize = 0;          // bytes per CRC32C record of a <file>.crc sidecar, e.g. 1048576; 0 - off
+    QString shmName;                    // POSIX shared-memory ring name, empty - disabled
+    unsigned shmSlots = 64;             // buffers kept in the ring
+    QString controlSocket;              // local socket name or path, empty - disabled
+    unsigned long long rxStartTimestamp = 0; // device timestamp of the first RX sample, 0 - stream start
+    unsigned long long rxStartOffset = 0;    // samples skipped after the RX trigger edge
+    unsigned long long dutyOn = 0;      // samples recorded per duty period, 0 - continuous
+    unsigned long long dutyOff = 0;     // samples skipped per duty period
+    QString txEndOfFile;                // stop, loop or pad
+    unsigned txReadAhead = 64;          // buffers read ahead of the TX stream
+    unsigned txPreRoll = 0;             // buffers required before start, 0 - the whole read-ahead
+    QString txFormat;                   // sc16 or cf32
+    bool txNormalize = false;           // cf32: scale the file peak to full scale
+    double txScale = 1.0;               // cf32: full scale fraction
+    double txGainDb = 0;                // digital gain of the TX stream, -60..24 dB
+    unsigned long long txSourceRate = 0; // sample rate of the TX files, 0 - sampleRate
+    QList<BurstConfig> bursts;          // scheduled TX instead of a continuous stream
+    WaveformConfig waveform;            // generated TX instead of fileName
+    QList<PlaylistEntry> playlist;      // sample-contiguous file sequence instead of fileName
+    ScanConfig scan;                    // RX over several frequencies instead of frequency
+    AgcConfig agc;                      // RX gain follows the signal level instead of gain
 
     QString fileName;
 };
@@ -0,0 +1,26 @@
+#include "PhaseProfile.hpp"
+
+void PhaseProfile::start()
+{
+    mPhases.clear();
+    mLast = 0;
+    mTimer.start();
+}
+
+void PhaseProfile::mark(const QString& phase)
+{
+    const auto now = mTimer.nsecsElapsed();
+
+    mPhases.append(qMakePair(phase, now - mLast));
+    mLast = now;
+}
+
+QString PhaseProfile::summary() const
+{
+    QString line;
+
+    for (const auto& phase : mPhases)
+        line += QString("%1 %2 ms, ").arg(phase.first).arg(phase.second / 1e6, 0, 'f', 1);
+
+    return line + QString("total %1 ms").arg(mLast / 1e6, 0, 'f', 1);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QPair>
+#include <QString>
+
+// Wall-clock time of consecutive phases, reported as one line:
+//   open 81.2 ms, fpga check 0.4 ms, ready 38.0 ms, total 119.6 ms
+class PhaseProfile
+{
+public:
+    void start();
+    /// Closes the phase running since the previous mark
+    void mark(const QString& phase);
+    QString summary() const;
+
+private:
+    QElapsedTimer mTimer;
+    qint64 mLast = 0;                   // ns
+    QList<QPair<QString, qint64>> mPhases;
+};
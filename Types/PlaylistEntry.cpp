@@ -0,0 +1,19 @@
+#include "PlaylistEntry.hpp"
+
+DefineJsonField(file_name)
+DefineJsonField(repeat)
+DefineJsonField(gap)
+
+void PlaylistEntry::fromJson(const QJsonObject& json)
+{
+    fileName = json[i_file_name].toString();
+    repeat = json[i_repeat].toInt(1);
+    gap = json[i_gap].toString().toULongLong();
+}
+
+void PlaylistEntry::fillJson(QJsonObject& json) const
+{
+    json[i_file_name] = fileName;
+    json[i_repeat] = int(repeat);
+    json[i_gap] = QString::number(gap);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "JsonConfig.hpp"
+
+// One file of a gapless TX playlist.
+// The gap of zero samples follows every repeat of the file.
+class PlaylistEntry : public JsonConfig
+{
+public:
+    ~PlaylistEntry() = default;
+
+    virtual bool valid() const override
+    {
+        return !fileName.isEmpty()
+            && repeat != 0;
+    };
+
+    virtual void fromJson(const QJsonObject& json) override;
+    virtual void fillJson(QJsonObject& json) const override;
+
+public:
+    QString fileName;
+    unsigned repeat = 1;
+    unsigned long long gap = 0;         // samples
+};
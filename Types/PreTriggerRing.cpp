@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <cstring>
+
+#include "PreTriggerRing.hpp"
+
+void PreTriggerRing::reset(quint32 capacityBytes)
+{
+    mCapacity = capacityBytes;
+    mHead = 0;
+    mSize = 0;
+
+    mRx1.resize(mCapacity);
+    mRx2.resize(mCapacity);
+}
+
+void PreTriggerRing::push(const QByteArray& rx1, const QByteArray& rx2)
+{
+    if (mCapacity == 0) return;
+
+    write(mRx1, rx1);
+    write(mRx2, rx2);
+
+    const quint32 length = std::min<quint32>(rx1.size(), mCapacity);
+    mHead = (mHead + quint32(rx1.size())) % mCapacity;
+    mSize = std::min(mSize + length, mCapacity);
+}
+
+quint32 PreTriggerRing::size() const
+{
+    return mSize;
+}
+
+void PreTriggerRing::read(int channel, quint32 offset, char* destination, quint32 length) const
+{
+    const auto& ring = channel == 1 ? mRx1 : mRx2;
+    const quint32 tail = (mHead + mCapacity - mSize) % mCapacity;
+    const quint32 start = (tail + offset) % mCapacity;
+    const quint32 first = std::min(length, mCapacity - start);
+
+    std::memcpy(destination, ring.constData() + start, first);
+    std::memcpy(destination + first, ring.constData(), length - first);
+}
+
+void PreTriggerRing::write(QByteArray& ring, const QByteArray& data)
+{
+    // Only the newest mCapacity bytes of an oversized buffer survive
+    const quint32 length = std::min<quint32>(data.size(), mCapacity);
+    const char* source = data.constData() + (data.size() - length);
+    const quint32 start = (mHead + quint32(data.size()) - length) % mCapacity;
+    const quint32 first = std::min(length, mCapacity - start);
+
+    std::memcpy(ring.data() + start, source, first);
+    std::memcpy(ring.data(), source + first, length - first);
+}
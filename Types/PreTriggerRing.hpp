@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QByteArray>
+
+// Preallocated RAM ring holding the most recent RX1/RX2 samples of an event
+// capture. Oldest data is overwritten; nothing is allocated after reset().
+class PreTriggerRing
+{
+public:
+    void reset(quint32 capacityBytes);
+    void push(const QByteArray& rx1, const QByteArray& rx2);
+
+    /// Filled size of one channel in bytes
+    quint32 size() const;
+    /// Copies length bytes of a channel starting offset bytes after the oldest byte
+    void read(int channel, quint32 offset, char* destination, quint32 length) const;
+
+private:
+    void write(QByteArray& ring, const QByteArray& data);
+
+private:
+    QByteArray mRx1;
+    QByteArray mRx2;
+
+    quint32 mCapacity = 0;
+    quint32 mHead = 0;
+    quint32 mSize = 0;
+};
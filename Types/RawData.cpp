@@ -60,6 +60,21 @@ void RawData::setIndex(unsigned int index)
     mIndex = index;
 }
 
+void RawData::setFrequency(unsigned long long frequency)
+{
+    mFrequency = frequency;
+}
+
+void RawData::setSampleOffset(unsigned long long offset)
+{
+    mSampleOffset = offset;
+}
+
+void RawData::setTimestamp(unsigned long long timestamp)
+{
+    mTimestamp = timestamp;
+}
+
 void RawData::clear()
 {
     mRx1.clear();
@@ -87,6 +102,21 @@ unsigned int RawData::index() const
     return mIndex;
 }
 
+unsigned long long RawData::frequency() const
+{
+    return mFrequency;
+}
+
+unsigned long long RawData::sampleOffset() const
+{
+    return mSampleOffset;
+}
+
+unsigned long long RawData::timestamp() const
+{
+    return mTimestamp;
+}
+
 QByteArray RawData::rx1() const
 {
     return mRx1;
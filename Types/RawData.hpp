@@ -19,6 +19,9 @@ public:
     void setRX1(const QByteArray& rx1);
     void setRX2(const QByteArray& rx2);
     void setIndex(unsigned int index);
+    void setFrequency(unsigned long long frequency);
+    void setSampleOffset(unsigned long long offset);
+    void setTimestamp(unsigned long long timestamp);
     void clear();
 
     bool valid() const;
@@ -26,6 +29,12 @@ public:
     unsigned int rxSize() const;
     unsigned int samplesCount() const;
     unsigned int index() const;
+    /// Center frequency the buffer was captured at, 0 - not tagged
+    unsigned long long frequency() const;
+    /// Stream sample of the first sample, for parts of a buffer
+    unsigned long long sampleOffset() const;
+    /// Device timestamp of the first sample, 0 - not known
+    unsigned long long timestamp() const;
     QByteArray rx1() const;
     QByteArray rx2() const;
 
@@ -34,6 +43,9 @@ public:
     QByteArray mRx2;
 
     unsigned int mIndex = 0;
+    unsigned long long mFrequency = 0;
+    unsigned long long mSampleOffset = 0;
+    unsigned long long mTimestamp = 0;
     unsigned int mRxSizeBytes = 0;
 
 };
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include "RawDataQueue.hpp"
+
+#define MAX_DROPPED_RANGES      4096
+
+RawDataQueue::RawDataQueue(quint32 capacity, OverloadPolicy policy)
+    : mCapacity(std::max<quint32>(capacity, 1)),
+      mPolicy(policy)
+{
+
+}
+
+bool RawDataQueue::push(const RawData& data)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (mClosed) return false;
+
+    if (mQueue.size() >= mCapacity)
+    {
+        switch (mPolicy)
+        {
+            case OverloadPolicy::Block:
+                mNotFull.wait(lock, [this]() { return mClosed || mQueue.size() < mCapacity; });
+                if (mClosed) return false;
+            break;
+            case OverloadPolicy::DropNewest:
+                drop(data);
+            return false;
+            case OverloadPolicy::DropOldest:
+                drop(mQueue.front());
+                mQueue.pop_front();
+            break;
+            case OverloadPolicy::Spill:
+                if (mSpillQueue.size() < mCapacity)
+                {
+                    mSpillQueue.push_back(data);
+                    ++mSpilled;
+                    mSpillAvailable.notify_one();
+                }
+                else drop(data);
+            return false;
+        }
+    }
+
+    mQueue.push_back(data);
+    mHighWatermark = std::max<quint32>(mHighWatermark, mQueue.size());
+    return mQueue.size() == 1;
+}
+
+bool RawDataQueue::pop(RawData& data)
+{
+    {
+        const std::lock_guard<std::mutex> lock(mMutex);
+        if (mQueue.empty()) return false;
+
+        data = mQueue.front();
+        mQueue.pop_front();
+    }
+
+    mNotFull.notify_one();
+    return true;
+}
+
+bool RawDataQueue::popSpilled(RawData& data)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mSpillAvailable.wait(lock, [this]() { return mClosed || !mSpillQueue.empty(); });
+    if (mSpillQueue.empty()) return false;
+
+    data = mSpillQueue.front();
+    mSpillQueue.pop_front();
+    return true;
+}
+
+void RawDataQueue::close()
+{
+    {
+        const std::lock_guard<std::mutex> lock(mMutex);
+        mClosed = true;
+    }
+
+    mNotFull.notify_all();
+    mSpillAvailable.notify_all();
+}
+
+quint64 RawDataQueue::dropped() const
+{
+    const std::lock_guard<std::mutex> lock(mMutex);
+    return mDropped;
+}
+
+quint64 RawDataQueue::spilled() const
+{
+    const std::lock_guard<std::mutex> lock(mMutex);
+    return mSpilled;
+}
+
+quint32 RawDataQueue::highWatermark() const
+{
+    const std::lock_guard<std::mutex> lock(mMutex);
+    return mHighWatermark;
+}
+
+QList<QPair<quint32, quint32>> RawDataQueue::droppedRanges() const
+{
+    const std::lock_guard<std::mutex> lock(mMutex);
+    return mDroppedRanges;
+}
+
+OverloadPolicy RawDataQueue::policyFromString(const QString& policy)
+{
+    if (policy == "block") return OverloadPolicy::Block;
+    if (policy == "drop_oldest") return OverloadPolicy::DropOldest;
+    if (policy == "spill") return OverloadPolicy::Spill;
+    return OverloadPolicy::DropNewest;
+}
+
+QString RawDataQueue::policyToString(OverloadPolicy policy)
+{
+    switch (policy)
+    {
+        case OverloadPolicy::Block: return "block";
+        case OverloadPolicy::DropNewest: return "drop_newest";
+        case OverloadPolicy::DropOldest: return "drop_oldest";
+        case OverloadPolicy::Spill: return "spill";
+    }
+    return QString();
+}
+
+void RawDataQueue::drop(const RawData& data)
+{
+    ++mDropped;
+
+    if (!mDroppedRanges.isEmpty() && mDroppedRanges.last().second + 1 == data.index())
+        mDroppedRanges.last().second = data.index();
+    else if (mDroppedRanges.size() < MAX_DROPPED_RANGES)
+        mDroppedRanges.append(qMakePair(data.index(), data.index()));
+}
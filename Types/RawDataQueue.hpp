@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QString>
+#include <QList>
+#include <QPair>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+#include "RawData.hpp"
+
+enum class OverloadPolicy
+{
+    Block,
+    DropNewest,
+    DropOldest,
+    Spill
+};
+
+// Bounded queue between the RX producer and the writer thread.
+// When the writer falls behind the overload policy decides what happens to
+// new buffers; every buffer that is not written is accounted for.
+class RawDataQueue
+{
+public:
+    RawDataQueue(quint32 capacity, OverloadPolicy policy);
+
+    /// Producer side. Returns true if the writer has to be woken up
+    bool push(const RawData& data);
+    bool pop(RawData& data);
+    /// Blocks until a spilled buffer is available or the queue is closed
+    bool popSpilled(RawData& data);
+    /// Releases blocked producers and the spill consumer
+    void close();
+
+    quint64 dropped() const;
+    quint64 spilled() const;
+    quint32 highWatermark() const;
+    /// Index ranges [first, last] of dropped buffers
+    QList<QPair<quint32, quint32>> droppedRanges() const;
+
+    static OverloadPolicy policyFromString(const QString& policy);
+    static QString policyToString(OverloadPolicy policy);
+
+private:
+    void drop(const RawData& data);
+
+private:
+    const quint32 mCapacity;
+    const OverloadPolicy mPolicy;
+
+    mutable std::mutex mMutex;
+    std::condition_variable mNotFull;
+    std::condition_variable mSpillAvailable;
+    std::deque<RawData> mQueue;
+    std::deque<RawData> mSpillQueue;
+    bool mClosed = false;
+
+    quint64 mDropped = 0;
+    quint64 mSpilled = 0;
+    quint32 mHighWatermark = 0;
+    QList<QPair<quint32, quint32>> mDroppedRanges;
+};
@@ -0,0 +1,57 @@
+#include <QJsonArray>
+
+#include "ScanConfig.hpp"
+
+DefineJsonField(frequencies)
+DefineJsonField(start)
+DefineJsonField(stop)
+DefineJsonField(step)
+DefineJsonField(dwell)
+DefineJsonField(settle)
+DefineJsonField(sweeps)
+
+bool ScanConfig::valid() const
+{
+    if (dwell <= 0 || settle < 0 || sweeps < 0) return false;
+    // A single frequency is a plain capture, segments are split on frequency changes
+    if (!frequencies.isEmpty()) return frequencies.size() > 1 && frequencies.size() <= MAX_SCAN_FREQUENCIES;
+    return start != 0 && step != 0 && start + step <= stop && (stop - start) / step < MAX_SCAN_FREQUENCIES;
+}
+
+QList<unsigned long long> ScanConfig::centers() const
+{
+    if (!frequencies.isEmpty()) return frequencies;
+
+    QList<unsigned long long> result;
+    for (auto frequency = start; frequency <= stop; frequency += step)
+        result.append(frequency);
+    return result;
+}
+
+void ScanConfig::fromJson(const QJsonObject& json)
+{
+    start = json[i_start].toString().toULongLong();
+    stop = json[i_stop].toString().toULongLong();
+    step = json[i_step].toString().toULongLong();
+    dwell = json[i_dwell].toDouble();
+    settle = json[i_settle].toDouble();
+    sweeps = json[i_sweeps].toInt();
+
+    frequencies.clear();
+    for (const auto& frequency : json[i_frequencies].toArray())
+        frequencies.append(frequency.toString().toULongLong());
+}
+
+void ScanConfig::fillJson(QJsonObject& json) const
+{
+    QJsonArray frequencyArray;
+    for (const auto frequency : frequencies) frequencyArray.append(QString::number(frequency));
+
+    json[i_frequencies] = frequencyArray;
+    json[i_start] = QString::number(start);
+    json[i_stop] = QString::number(stop);
+    json[i_step] = QString::number(step);
+    json[i_dwell] = dwell;
+    json[i_settle] = settle;
+    json[i_sweeps] = sweeps;
+}
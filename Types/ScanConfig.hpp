@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QList>
+
+#include "JsonConfig.hpp"
+
+#define MAX_SCAN_FREQUENCIES    256     // fastlock profiles the FPGA can hold
+
+// RX scan over several center frequencies on one open device.
+// Either an explicit hop list or a start..stop range with a step is used.
+// Every dwell records dwell seconds after settle seconds of discarded samples.
+class ScanConfig : public JsonConfig
+{
+public:
+    ~ScanConfig() = default;
+
+    virtual bool valid() const override;
+
+    virtual void fromJson(const QJsonObject& json) override;
+    virtual void fillJson(QJsonObject& json) const override;
+
+    bool enabled() const { return !frequencies.isEmpty() || step != 0; }
+    /// Center frequencies in scan order
+    QList<unsigned long long> centers() const;
+
+public:
+    QList<unsigned long long> frequencies;
+    unsigned long long start = 0;
+    unsigned long long stop = 0;
+    unsigned long long step = 0;
+    double dwell = 0;                   // seconds recorded per frequency
+    double settle = 0;                  // seconds discarded after a retune
+    int sweeps = 0;                     // passes over the list, 0 - until stopped
+};
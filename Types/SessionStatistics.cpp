@@ -0,0 +1,102 @@
+#include <QJsonArray>
+
+#include "SessionStatistics.hpp"
+
+DefineJsonField(samplerate)
+DefineJsonField(samples_sent)
+DefineJsonField(pre_roll)
+DefineJsonField(capacity)
+DefineJsonField(low_watermark)
+DefineJsonField(underruns)
+DefineJsonField(underrun_samples)
+DefineJsonField(underrun_events)
+DefineJsonField(sample_offset)
+DefineJsonField(time)
+DefineJsonField(missing)
+DefineJsonField(bursts_sent)
+DefineJsonField(bursts_late)
+DefineJsonField(gain_db)
+DefineJsonField(gain_min_db)
+DefineJsonField(gain_max_db)
+DefineJsonField(gain_changes)
+DefineJsonField(clipped_values)
+DefineJsonField(peak_dbfs)
+DefineJsonField(crest_factor_db)
+DefineJsonField(clean)
+
+void SessionStatistics::fromJson(const QJsonObject& json)
+{
+    sampleRate = json[i_samplerate].toString().toULongLong();
+    samplesSent = json[i_samples_sent].toString().toULongLong();
+    preRoll = json[i_pre_roll].toInt();
+    capacity = json[i_capacity].toInt();
+    lowWatermark = json[i_low_watermark].toInt();
+    underruns = json[i_underruns].toString().toULongLong();
+    underrunSamples = json[i_underrun_samples].toString().toULongLong();
+    burstsSent = json[i_bursts_sent].toString().toULongLong();
+    burstsLate = json[i_bursts_late].toString().toULongLong();
+    gainDb = json[i_gain_db].toDouble();
+    gainMinDb = json[i_gain_min_db].toDouble(gainDb);
+    gainMaxDb = json[i_gain_max_db].toDouble(gainDb);
+    clippedValues = json[i_clipped_values].toString().toULongLong();
+    peakDbfs = json[i_peak_dbfs].toDouble();
+    crestFactorDb = json[i_crest_factor_db].toDouble();
+
+    underrunEvents.clear();
+    for (const auto& value : json[i_underrun_events].toArray())
+    {
+        const auto event = value.toObject();
+        underrunEvents.append({ event[i_sample_offset].toString().toULongLong(),
+                                event[i_time].toString().toLongLong(),
+                                unsigned(event[i_missing].toInt()) });
+    }
+
+    gainChanges.clear();
+    for (const auto& value : json[i_gain_changes].toArray())
+    {
+        const auto change = value.toObject();
+        gainChanges.append({ change[i_sample_offset].toString().toULongLong(),
+                             change[i_gain_db].toDouble() });
+    }
+}
+
+void SessionStatistics::fillJson(QJsonObject& json) const
+{
+    QJsonArray events;
+    for (const auto& underrun : underrunEvents)
+    {
+        QJsonObject event;
+        event[i_sample_offset] = QString::number(underrun.sampleOffset);
+        event[i_time] = QString::number(underrun.time);
+        event[i_missing] = int(underrun.missing);
+        events.append(event);
+    }
+
+    QJsonArray changes;
+    for (const auto& gainChange : gainChanges)
+    {
+        QJsonObject change;
+        change[i_sample_offset] = QString::number(gainChange.sampleOffset);
+        change[i_gain_db] = gainChange.gainDb;
+        changes.append(change);
+    }
+
+    json[i_samplerate] = QString::number(sampleRate);
+    json[i_samples_sent] = QString::number(samplesSent);
+    json[i_pre_roll] = int(preRoll);
+    json[i_capacity] = int(capacity);
+    json[i_low_watermark] = int(lowWatermark);
+    json[i_underruns] = QString::number(underruns);
+    json[i_underrun_samples] = QString::number(underrunSamples);
+    json[i_underrun_events] = events;
+    json[i_bursts_sent] = QString::number(burstsSent);
+    json[i_bursts_late] = QString::number(burstsLate);
+    json[i_gain_db] = gainDb;
+    json[i_gain_min_db] = gainMinDb;
+    json[i_gain_max_db] = gainMaxDb;
+    json[i_gain_changes] = changes;
+    json[i_clipped_values] = QString::number(clippedValues);
+    json[i_peak_dbfs] = peakDbfs;
+    json[i_crest_factor_db] = crestFactorDb;
+    json[i_clean] = clean();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QVector>
+
+#include "JsonConfig.hpp"
+
+// Summary of a TX session, written as tx_session.json when it stops
+class SessionStatistics : public JsonConfig
+{
+public:
+    struct Underrun
+    {
+        unsigned long long sampleOffset;    // samples sent before the gap
+        long long time;                     // ms since epoch
+        unsigned missing;                   // zero samples sent instead
+    };
+
+    struct GainChange
+    {
+        unsigned long long sampleOffset;    // source samples sent at the old gain
+        double gainDb;
+    };
+
+    ~SessionStatistics() = default;
+
+    virtual void fromJson(const QJsonObject& json) override;
+    virtual void fillJson(QJsonObject& json) const override;
+
+    bool clean() const { return underruns == 0 && burstsLate == 0; }
+
+public:
+    unsigned long long sampleRate = 0;
+    unsigned long long samplesSent = 0;
+    unsigned preRoll = 0;                   // samples buffered before start
+    unsigned capacity = 0;                  // samples of read-ahead
+    unsigned lowWatermark = 0;              // smallest fill seen by the stream
+    unsigned long long underruns = 0;
+    unsigned long long underrunSamples = 0;
+    QVector<Underrun> underrunEvents;       // first MAX_UNDERRUN_EVENTS
+    unsigned long long burstsSent = 0;
+    unsigned long long burstsLate = 0;
+    double gainDb = 0;                      // digital gain at the end of the session
+    double gainMinDb = 0;                   // range of the digital gain over the session
+    double gainMaxDb = 0;
+    QVector<GainChange> gainChanges;        // live changes, first MAX_GAIN_CHANGES
+    unsigned long long clippedValues = 0;   // I or Q values saturated to the DAC range
+    double peakDbfs = 0;
+    double crestFactorDb = 0;               // peak to average power
+};
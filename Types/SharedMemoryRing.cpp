@@ -0,0 +1,188 @@
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "SharedMemoryRing.hpp"
+
+#define SLOT_ALIGNMENT          64
+
+SharedMemoryRing::~SharedMemoryRing()
+{
+    close();
+}
+
+bool SharedMemoryRing::create(const char* name, uint32_t slotCount, uint32_t channelBytes, uint64_t sampleRate)
+{
+    close();
+    if (slotCount < 2 || channelBytes == 0) return false;
+
+    const uint64_t stride = (sizeof(Slot) + 2ull * channelBytes + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT * SLOT_ALIGNMENT;
+    const size_t size = sizeof(Header) + slotCount * stride;
+
+    shm_unlink(name);
+    const int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) return false;
+
+    if (ftruncate(fd, off_t(size)) != 0)
+    {
+        ::close(fd);
+        shm_unlink(name);
+        return false;
+    }
+
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED)
+    {
+        shm_unlink(name);
+        return false;
+    }
+
+    mHeader = new (memory) Header;
+    mSize = size;
+    mOwner = true;
+    std::strncpy(mName, name, sizeof(mName) - 1);
+
+    mHeader->version = VERSION;
+    mHeader->slotCount = slotCount;
+    mHeader->channelBytes = channelBytes;
+    mHeader->sampleRate = sampleRate;
+    mHeader->slotStride = stride;
+    mHeader->head.store(0, std::memory_order_relaxed);
+
+    for (uint32_t i = 0; i < slotCount; ++i)
+        new (slot(i)) Slot { { 0 }, 0, 0, 0 };
+
+    // Readers check the magic last, so they never see a half-initialised header
+    std::atomic_thread_fence(std::memory_order_release);
+    mHeader->magic = MAGIC;
+
+    return true;
+}
+
+bool SharedMemoryRing::attach(const char* name)
+{
+    struct stat info;
+
+    close();
+
+    const int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return false;
+
+    if (fstat(fd, &info) != 0 || size_t(info.st_size) < sizeof(Header))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void* memory = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) return false;
+
+    mHeader = static_cast<Header*>(memory);
+    mSize = size_t(info.st_size);
+    mOwner = false;
+
+    if (mHeader->magic != MAGIC
+    ||  mHeader->version != VERSION
+    ||  mSize < sizeof(Header) + mHeader->slotCount * mHeader->slotStride)
+    {
+        close();
+        return false;
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return true;
+}
+
+void SharedMemoryRing::close()
+{
+    if (!mHeader) return;
+
+    munmap(mHeader, mSize);
+    if (mOwner) shm_unlink(mName);
+
+    mHeader = nullptr;
+    mSize = 0;
+    mOwner = false;
+}
+
+void SharedMemoryRing::publish(const void* rx1, const void* rx2, uint32_t bytes,
+                               uint64_t sampleOffset, uint32_t bufferIndex)
+{
+    if (!mHeader || !mOwner) return;
+
+    const uint64_t sequence = mHeader->head.load(std::memory_order_relaxed) + 1;
+    const auto target = slot(sequence);
+    const auto payload = reinterpret_cast<char*>(target + 1);
+    const uint32_t length = bytes < mHeader->channelBytes ? bytes : mHeader->channelBytes;
+
+    target->sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(payload, rx1, length);
+    std::memcpy(payload + mHeader->channelBytes, rx2, length);
+    target->sampleOffset = sampleOffset;
+    target->bytes = length;
+    target->bufferIndex = bufferIndex;
+
+    target->sequence.store(sequence, std::memory_order_release);
+    mHeader->head.store(sequence, std::memory_order_release);
+}
+
+uint64_t SharedMemoryRing::head() const
+{
+    return mHeader ? mHeader->head.load(std::memory_order_acquire) : 0;
+}
+
+SharedMemoryRing::ReadStatus SharedMemoryRing::read(uint64_t& sequence, View& view) const
+{
+    const uint64_t last = head();
+    const uint64_t slots = mHeader ? mHeader->slotCount : 0;
+
+    if (sequence == 0 || sequence > last) return ReadStatus::NoData;
+
+    // The slot of last + 1 may already be in rewrite, so it is not counted as kept
+    if (last - sequence + 1 >= slots)
+    {
+        sequence = last + 2 - slots;
+        return ReadStatus::Overrun;
+    }
+
+    const auto source = slot(sequence);
+    if (source->sequence.load(std::memory_order_acquire) != sequence)
+    {
+        sequence = last + 2 - slots;
+        return ReadStatus::Overrun;
+    }
+
+    view.slot = source;
+    view.rx1 = reinterpret_cast<const char*>(source + 1);
+    view.rx2 = view.rx1 + mHeader->channelBytes;
+    view.bytes = source->bytes;
+    view.sequence = sequence;
+    view.sampleOffset = source->sampleOffset;
+
+    return ReadStatus::Ok;
+}
+
+bool SharedMemoryRing::valid(const View& view) const
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return view.slot && view.slot->sequence.load(std::memory_order_relaxed) == view.sequence;
+}
+
+const SharedMemoryRing::Header* SharedMemoryRing::header() const
+{
+    return mHeader;
+}
+
+SharedMemoryRing::Slot* SharedMemoryRing::slot(uint64_t sequence) const
+{
+    auto base = reinterpret_cast<char*>(mHeader) + sizeof(Header);
+    return reinterpret_cast<Slot*>(base + (sequence % mHeader->slotCount) * mHeader->slotStride);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// POSIX shared-memory ring publishing deinterleaved RX buffers to local
+// processes. This header has no Qt dependency so consumers can include it as is.
+//
+// | Header | Slot 0 | payload 0 | Slot 1 | payload 1 | ... |
+//
+// Payload of a slot is RX1 followed by RX2, channelBytes each (SC16_Q11).
+//
+// Reader protocol:
+//   1. sequence = head() + 1 to start live, or any sequence still in the ring
+//   2. read(sequence, view) - Ok, NoData (not published yet) or Overrun
+//      (the slot was already reused; sequence is moved to the oldest slot kept)
+//   3. consume view.rx1/view.rx2 in place
+//   4. valid(view) - false if the producer overwrote the slot meanwhile
+//   5. ++sequence
+// The producer never waits for readers, any number of them can attach.
+class SharedMemoryRing
+{
+public:
+    static constexpr uint32_t MAGIC   = 0x52534642; // "BFSR"
+    static constexpr uint32_t VERSION = 1;
+
+    struct alignas(64) Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t slotCount;
+        uint32_t channelBytes;
+        uint64_t sampleRate;
+        uint64_t slotStride;
+        std::atomic<uint64_t> head;         // last published sequence, 0 - none
+    };
+
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> sequence;     // 0 while being written
+        uint64_t sampleOffset;
+        uint32_t bytes;
+        uint32_t bufferIndex;
+    };
+
+    struct View
+    {
+        const Slot* slot = nullptr;
+        const char* rx1 = nullptr;
+        const char* rx2 = nullptr;
+        uint32_t bytes = 0;
+        uint64_t sequence = 0;
+        uint64_t sampleOffset = 0;
+    };
+
+    enum class ReadStatus
+    {
+        Ok,
+        NoData,
+        Overrun
+    };
+
+    SharedMemoryRing() = default;
+    ~SharedMemoryRing();
+
+    SharedMemoryRing(const SharedMemoryRing&) = delete;
+    SharedMemoryRing& operator=(const SharedMemoryRing&) = delete;
+
+    /// Producer: creates the segment, replacing a stale one with the same name
+    bool create(const char* name, uint32_t slotCount, uint32_t channelBytes, uint64_t sampleRate);
+    /// Consumer: attaches read-only to an existing segment
+    bool attach(const char* name);
+    void close();
+
+    /// Producer: copies one deinterleaved buffer into the next slot
+    void publish(const void* rx1, const void* rx2, uint32_t bytes,
+                 uint64_t sampleOffset, uint32_t bufferIndex);
+
+    uint64_t head() const;
+    ReadStatus read(uint64_t& sequence, View& view) const;
+    bool valid(const View& view) const;
+
+    const Header* header() const;
+
+private:
+    Slot* slot(uint64_t sequence) const;
+
+private:
+    Header* mHeader = nullptr;
+    size_t mSize = 0;
+    bool mOwner = false;
+    char mName[256] = {};
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared-memory ring needs lock-free 64-bit atomics");
@@ -0,0 +1,65 @@
+#include <QJsonArray>
+
+#include <cmath>
+
+#include "WaveformConfig.hpp"
+
+DefineJsonField(type)
+DefineJsonField(amplitude)
+DefineJsonField(frequency)
+DefineJsonField(start_frequency)
+DefineJsonField(stop_frequency)
+DefineJsonField(sweep_time)
+DefineJsonField(tones)
+DefineJsonField(symbol_rate)
+DefineJsonField(prbs_order)
+DefineJsonField(noise)
+DefineJsonField(seed)
+
+bool WaveformConfig::valid() const
+{
+    if (type == "tone") return true;
+    if (type == "noise") return noise > 0;
+    if (type == "linear_chirp") return sweepTime > 0;
+    if (type == "exponential_chirp")
+        return sweepTime > 0 && startFrequency * stopFrequency > 0 && startFrequency != stopFrequency;
+    if (type == "multitone") return !tones.isEmpty();
+    if (type == "bpsk" || type == "qpsk") return symbolRate > 0;
+    return false;
+}
+
+void WaveformConfig::fromJson(const QJsonObject& json)
+{
+    type = json[i_type].toString();
+    amplitude = json[i_amplitude].toDouble(0.7);
+    frequency = json[i_frequency].toDouble();
+    startFrequency = json[i_start_frequency].toDouble();
+    stopFrequency = json[i_stop_frequency].toDouble();
+    sweepTime = json[i_sweep_time].toDouble();
+    symbolRate = json[i_symbol_rate].toDouble();
+    prbsOrder = json[i_prbs_order].toInt(15);
+    noise = json[i_noise].toDouble();
+    seed = json[i_seed].toInt(1);
+
+    tones.clear();
+    for (const auto& tone : json[i_tones].toArray())
+        tones.append(tone.toDouble());
+}
+
+void WaveformConfig::fillJson(QJsonObject& json) const
+{
+    QJsonArray toneArray;
+    for (const auto tone : tones) toneArray.append(tone);
+
+    json[i_type] = type;
+    json[i_amplitude] = amplitude;
+    json[i_frequency] = frequency;
+    json[i_start_frequency] = startFrequency;
+    json[i_stop_frequency] = stopFrequency;
+    json[i_sweep_time] = sweepTime;
+    json[i_tones] = toneArray;
+    json[i_symbol_rate] = symbolRate;
+    json[i_prbs_order] = int(prbsOrder);
+    json[i_noise] = noise;
+    json[i_seed] = int(seed);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QList>
+
+#include "JsonConfig.hpp"
+
+// Built-in TX waveform. Frequencies are baseband offsets in Hz, amplitudes
+// are fractions of the DAC full scale.
+//
+// type: tone, linear_chirp, exponential_chirp, multitone, noise, bpsk, qpsk
+class WaveformConfig : public JsonConfig
+{
+public:
+    ~WaveformConfig() = default;
+
+    virtual bool valid() const override;
+
+    virtual void fromJson(const QJsonObject& json) override;
+    virtual void fillJson(QJsonObject& json) const override;
+
+    bool enabled() const { return !type.isEmpty(); }
+
+public:
+    QString type;
+    double amplitude = 0.7;
+    double frequency = 0;
+    double startFrequency = 0;          // chirps
+    double stopFrequency = 0;
+    double sweepTime = 0;               // seconds
+    QList<double> tones;                // multitone
+    double symbolRate = 0;              // bpsk, qpsk
+    unsigned prbsOrder = 15;
+    double noise = 0;                   // rms added to any type, the level of the noise type
+    unsigned seed = 1;
+};
@@ -15,6 +15,7 @@ int main(int argc, char** argv)
     signal(SIGINT , systemSignalsHandler);
     signal(SIGABRT, systemSignalsHandler);
     signal(SIGSEGV, systemSignalsHandler);
+    signal(SIGUSR1, systemSignalsHandler);
 
     qSetMessagePattern("[%{time h:mm:ss:zzz}]["
                        "%{if-debug}D%{endif}"
@@ -50,6 +51,12 @@ void systemSignalsHandler(int signalNumber)
 {
     static bool accepted = false;
 
+    if (signalNumber == SIGUSR1)
+    {
+        Application::requestEventTrigger();
+        return;
+    }
+
     if (!accepted)
     {
         qInfo("System signal accepted: %i", signalNumber);
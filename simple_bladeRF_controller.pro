@@ -1,31 +1,92 @@
 QT -= gui
+QT += network
 
 CONFIG += c++17 console
 CONFIG -= app_bundle
 
-LIBS += -lbladeRF libm.a
+LIBS += -lbladeRF -lrt libm.a
+
+# Sample processing loops are written to be auto-vectorized
+QMAKE_CXXFLAGS_RELEASE += -ftree-vectorize -fno-math-errno
 
 SOURCES += \
     Application.cpp \
+    BladeRfBurstStream.cpp \
     BladeRfDeviceController.cpp \
     #BladeRfDevicesManager.cpp \
     BladeRfStream.cpp \
+    ControlServer.cpp \
+    MissionScheduler.cpp \
     Other/conversions.c \
     Other/dc_calibration.c \
+    Processing/Crc32c.cpp \
+    Processing/IqCodec.cpp \
+    Processing/PolyphaseResampler.cpp \
+    Processing/SampleConversion.cpp \
+    Processing/SignalStats.cpp \
+    Processing/WaveformGenerator.cpp \
     RawDataWriter.cpp \
+    Tx/TxFeed.cpp \
+    Tx/TxFileSource.cpp \
+    Tx/TxGainSource.cpp \
+    Tx/TxPlaylistSource.cpp \
+    Tx/TxResampleSource.cpp \
+    Tx/TxWaveformSource.cpp \
+    Types/AgcConfig.cpp \
+    Types/BurstConfig.cpp \
+    Types/CaptureMetadata.cpp \
+    Types/CrcSidecar.cpp \
+    Types/FpgaImageCache.cpp \
     Types/MissionConfig.cpp \
+    Types/PhaseProfile.cpp \
+    Types/PlaylistEntry.cpp \
+    Types/PreTriggerRing.cpp \
     Types/RawData.cpp \
+    Types/RawDataQueue.cpp \
+    Types/ScanConfig.cpp \
+    Types/SessionStatistics.cpp \
+    Types/SharedMemoryRing.cpp \
+    Types/WaveformConfig.cpp \
     main.cpp
 
 HEADERS += \
     Application.hpp \
+    BladeRfBurstStream.hpp \
     BladeRfDeviceController.hpp \
     #BladeRfDevicesManager.hpp \
     BladeRfStream.hpp \
+    ControlServer.hpp \
+    MissionScheduler.hpp \
     Other/conversions.h \
     Other/dc_calibration.h \
+    Processing/Crc32c.hpp \
+    Processing/IqCodec.hpp \
+    Processing/PolyphaseResampler.hpp \
+    Processing/SampleConversion.hpp \
+    Processing/SignalStats.hpp \
+    Processing/WaveformGenerator.hpp \
     RawDataWriter.hpp \
+    Tx/TxFeed.hpp \
+    Tx/TxFileSource.hpp \
+    Tx/TxGainSource.hpp \
+    Tx/TxPlaylistSource.hpp \
+    Tx/TxResampleSource.hpp \
+    Tx/TxSource.hpp \
+    Tx/TxWaveformSource.hpp \
+    Types/AgcConfig.hpp \
     Types/BladeRFDeviceState.hpp \
+    Types/BurstConfig.hpp \
+    Types/CaptureMetadata.hpp \
+    Types/CrcSidecar.hpp \
+    Types/FpgaImageCache.hpp \
     Types/JsonConfig.hpp \
     Types/MissionConfig.hpp \
-    Types/RawData.hpp
\ No newline at end of file
+    Types/PhaseProfile.hpp \
+    Types/PlaylistEntry.hpp \
+    Types/PreTriggerRing.hpp \
+    Types/RawData.hpp \
+    Types/RawDataQueue.hpp \
+    Types/ScanConfig.hpp \
+    Types/SessionStatistics.hpp \
+    Types/SharedMemoryRing.hpp \
+    Types/WaveformConfig.hpp
\ No newline at end of file